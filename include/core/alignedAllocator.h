@@ -0,0 +1,55 @@
+﻿#ifndef G3_CORE_ALIGNED_ALLOCATOR
+#define G3_CORE_ALIGNED_ALLOCATOR
+
+#include <cstddef>
+#include <new>
+#include <limits>
+
+namespace g3
+{
+    // default alignment of the SoA buffers, wide enough for one AVX register
+    inline constexpr std::size_t simdAlignment = 32;
+
+    // std::allocator replacement that returns 'Alignment'-aligned storage,
+    // so that std::vector can be used as the backing store of SIMD friendly arrays
+    template<typename T, std::size_t Alignment = simdAlignment>
+    class AlignedAllocator
+    {
+        static_assert(Alignment >= alignof(T), "alignment is weaker than the alignment of T");
+        static_assert((Alignment & (Alignment - 1)) == 0, "alignment must be a power of two");
+
+    public:
+        using value_type      = T;
+        using size_type       = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using self_type       = AlignedAllocator<T, Alignment>;
+
+        static constexpr std::size_t alignment = Alignment;
+
+        template<typename U>
+        struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+        // constructors
+        AlignedAllocator() noexcept {}
+        template<typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+        // functions
+        T* allocate(size_type n)
+        {
+            if (n > std::numeric_limits<size_type>::max() / sizeof(T)) throw std::bad_array_new_length();
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+        }
+
+        void deallocate(T *p, size_type) noexcept
+        { ::operator delete(p, std::align_val_t(Alignment)); }
+
+        // operator functions
+        template<typename U>
+        bool operator == (const AlignedAllocator<U, Alignment> &) const noexcept { return true; }
+        template<typename U>
+        bool operator != (const AlignedAllocator<U, Alignment> &) const noexcept { return false; }
+    };
+}
+
+#endif
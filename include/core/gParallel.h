@@ -0,0 +1,79 @@
+﻿#ifndef G3_CORE_G_PARALLEL
+#define G3_CORE_G_PARALLEL
+
+#include <cstddef>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace g3
+{
+    namespace gParallel
+    {
+        inline int hardwareThreadCount()
+        {
+            auto n = std::thread::hardware_concurrency();
+            return (n > 0) ? static_cast<int>(n) : 1;
+        }
+
+        // thread count knob convention: values <= 0 mean "use all hardware threads"
+        inline int resolveThreadCount(int threadCount)
+        { return (threadCount > 0) ? threadCount : hardwareThreadCount(); }
+
+        // Split [begin, end) into 'blockCount' contiguous blocks of (almost) equal size and
+        // call f(blockIndex, blockBegin, blockEnd) for each of them, one thread per block.
+        // The split only depends on the range and blockCount, so per-block partial results
+        // can be combined in a deterministic order. The calling thread runs block 0.
+        template<typename F>
+        void forBlocks(std::size_t begin, std::size_t end, int blockCount, F f)
+        {
+            if (end <= begin) return;
+            auto n = end - begin;
+            auto blocks = static_cast<std::size_t>(std::max(blockCount, 1));
+            blocks = std::min(blocks, n);
+            auto blockSize = (n + blocks - 1) / blocks;
+            if (blocks <= 1)
+            {
+                f(0, begin, end);
+                return;
+            }
+
+            std::vector<std::thread> threads;
+            threads.reserve(blocks - 1);
+            for (std::size_t i = 1; i < blocks; ++i)
+            {
+                auto b = begin + i * blockSize;
+                auto e = std::min(b + blockSize, end);
+                if (b >= e) break;
+                threads.emplace_back([&f, i, b, e]() { f(static_cast<int>(i), b, e); });
+            }
+            f(0, begin, std::min(begin + blockSize, end));
+            for (auto &t : threads) t.join();
+        }
+
+        // call f(i) for every i in [begin, end) using 'threadCount' threads
+        template<typename F>
+        void forEach(std::size_t begin, std::size_t end, F f, int threadCount = 0)
+        {
+            forBlocks(begin, end, resolveThreadCount(threadCount),
+                [&f](int, std::size_t b, std::size_t e) { for (auto i = b; i < e; ++i) f(i); });
+        }
+
+        // fork-join of two tasks, 'g' runs on a new thread when 'parallel' is true
+        template<typename F, typename G>
+        void invoke(F f, G g, bool parallel = true)
+        {
+            if (!parallel)
+            {
+                f();
+                g();
+                return;
+            }
+            std::thread t(g);
+            f();
+            t.join();
+        }
+    }
+}
+
+#endif
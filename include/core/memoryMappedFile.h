@@ -0,0 +1,228 @@
+﻿#ifndef G3_CORE_MEMORY_MAPPED_FILE
+#define G3_CORE_MEMORY_MAPPED_FILE
+
+#include <cstddef>
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace g3
+{
+    // Whole file memory mapping. The mapping starts on a page boundary, so the data is
+    // aligned for any element type stored at a suitable offset in the file, and pages
+    // are only read from disk when touched. Read only mappings share the page cache;
+    // copy on write mappings may be modified in memory, the file itself never changes
+    // and modified pages are backed by swap. Failures are reported by open() returning
+    // false and leave the object closed; an empty file opens with size 0 and no data.
+    class MemoryMappedFile
+    {
+    public:
+        enum Mode
+        {
+            ReadOnly,
+            CopyOnWrite
+        };
+
+        // static functions
+        static std::size_t pageSize()
+        {
+#if defined(_WIN32)
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            return static_cast<std::size_t>(info.dwPageSize);
+#else
+            return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+        }
+
+        // constructors
+        MemoryMappedFile() : _data(nullptr), _size(0), _mode(ReadOnly), _isOpen(false) {}
+        MemoryMappedFile(const std::string &path, Mode mode = ReadOnly) :
+            _data(nullptr), _size(0), _mode(ReadOnly), _isOpen(false)
+        { open(path, mode); }
+
+        MemoryMappedFile(const MemoryMappedFile &) = delete;
+        MemoryMappedFile& operator = (const MemoryMappedFile &) = delete;
+
+        MemoryMappedFile(MemoryMappedFile &&f) noexcept :
+            _data(nullptr), _size(0), _mode(ReadOnly), _isOpen(false)
+        { swap(f); }
+
+        MemoryMappedFile& operator = (MemoryMappedFile &&f) noexcept
+        {
+            if (this != &f)
+            {
+                close();
+                swap(f);
+            }
+            return *this;
+        }
+
+        ~MemoryMappedFile() { close(); }
+
+        // functions
+        bool open(const std::string &path, Mode mode = ReadOnly)
+        {
+            close();
+#if defined(_WIN32)
+            HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) return false;
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(file, &size))
+            {
+                CloseHandle(file);
+                return false;
+            }
+            if (size.QuadPart > 0)
+            {
+                HANDLE mapping = CreateFileMappingA(file, nullptr, (mode == CopyOnWrite) ? PAGE_WRITECOPY : PAGE_READONLY,
+                                                    0, 0, nullptr);
+                if (mapping == nullptr)
+                {
+                    CloseHandle(file);
+                    return false;
+                }
+                auto view = MapViewOfFile(mapping, (mode == CopyOnWrite) ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+                CloseHandle(mapping);
+                if (view == nullptr)
+                {
+                    CloseHandle(file);
+                    return false;
+                }
+                _data = static_cast<unsigned char*>(view);
+            }
+            CloseHandle(file);
+            _size = static_cast<std::size_t>(size.QuadPart);
+#else
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+            struct stat st;
+            if (fstat(fd, &st) != 0)
+            {
+                ::close(fd);
+                return false;
+            }
+            if (st.st_size > 0)
+            {
+                int prot = (mode == CopyOnWrite) ? (PROT_READ | PROT_WRITE) : PROT_READ;
+                auto p = mmap(nullptr, static_cast<std::size_t>(st.st_size), prot, MAP_PRIVATE, fd, 0);
+                if (p == MAP_FAILED)
+                {
+                    ::close(fd);
+                    return false;
+                }
+                _data = static_cast<unsigned char*>(p);
+            }
+            // the mapping keeps its own reference to the file
+            ::close(fd);
+            _size = static_cast<std::size_t>(st.st_size);
+#endif
+            _mode = mode;
+            _isOpen = true;
+            return true;
+        }
+
+        void close()
+        {
+            if (_data != nullptr)
+            {
+#if defined(_WIN32)
+                UnmapViewOfFile(_data);
+#else
+                munmap(_data, _size);
+#endif
+            }
+            _data = nullptr;
+            _size = 0;
+            _mode = ReadOnly;
+            _isOpen = false;
+        }
+
+        bool isOpen() const { return _isOpen; }
+        Mode mode() const { return _mode; }
+        std::size_t size() const { return _size; }
+
+        const unsigned char* data() const { return _data; }
+        // writable data of a copy on write mapping, nullptr for read only mappings
+        unsigned char* writableData() { return (_mode == CopyOnWrite) ? _data : nullptr; }
+
+        // Hint that bytes [offset, offset + length) are read next, so the kernel starts
+        // reading them ahead of the accesses.
+        void willNeed(std::size_t offset, std::size_t length) const
+        {
+#if defined(_WIN32)
+            WIN32_MEMORY_RANGE_ENTRY range;
+            if (!pageRange(offset, length, range.VirtualAddress, range.NumberOfBytes)) return;
+            PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+            void *p;
+            std::size_t n;
+            if (pageRange(offset, length, p, n)) madvise(p, n, MADV_WILLNEED);
+#endif
+        }
+
+        // Hint that the whole pages inside [offset, offset + length) are not read again
+        // soon, so their memory can go to other data. Read only mappings only: dropping
+        // pages of a copy on write mapping would discard the changes made to them.
+        void release(std::size_t offset, std::size_t length) const
+        {
+            if (_mode != ReadOnly) return;
+            auto page = pageSize();
+            auto begin = (offset + page - 1) / page * page;
+            auto end = std::min(offset + length, _size);
+            end = (end == _size) ? end : end / page * page;
+            if (end <= begin) return;
+            void *p;
+            std::size_t n;
+            if (!pageRange(begin, end - begin, p, n)) return;
+#if defined(_WIN32)
+            // the pages stay valid, only removed from the working set
+            VirtualUnlock(p, n);
+#else
+            madvise(p, n, MADV_DONTNEED);
+#endif
+        }
+
+        void swap(MemoryMappedFile &f) noexcept
+        {
+            std::swap(_data, f._data);
+            std::swap(_size, f._size);
+            std::swap(_mode, f._mode);
+            std::swap(_isOpen, f._isOpen);
+        }
+
+    private:
+        // page aligned address and length covering [offset, offset + length)
+        template<typename Size>
+        bool pageRange(std::size_t offset, std::size_t length, void *&p, Size &n) const
+        {
+            if (_data == nullptr || offset >= _size) return false;
+            auto page = pageSize();
+            auto begin = offset / page * page;
+            auto end = std::min(offset + length, _size);
+            p = _data + begin;
+            n = static_cast<Size>(end - begin);
+            return true;
+        }
+
+        unsigned char *_data;
+        std::size_t _size;
+        Mode _mode;
+        bool _isOpen;
+    };
+}
+
+#endif
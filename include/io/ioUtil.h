@@ -0,0 +1,305 @@
+﻿#ifndef G3_IO_IO_UTIL
+#define G3_IO_IO_UTIL
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace g3
+{
+    // Scanning and formatting helpers of the text mesh readers and writers. The scan
+    // functions work on [p, end) ranges of a mapped file, never read past 'end' and
+    // never allocate. Parse functions follow std::from_chars: they return the position
+    // after the parsed text, or their input position if there is nothing to parse,
+    // and are locale independent.
+    namespace ioUtil
+    {
+        inline bool isSpace(char c)
+        { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v'; }
+
+        inline bool isDigit(char c)
+        { return static_cast<unsigned>(c - '0') < 10u; }
+
+        inline const char* skipSpace(const char *p, const char *end)
+        {
+            while (p < end && isSpace(*p)) ++p;
+            return p;
+        }
+
+        inline const char* skipToken(const char *p, const char *end)
+        {
+            while (p < end && !isSpace(*p)) ++p;
+            return p;
+        }
+
+        // position after the next '\n', or end
+        inline const char* skipLine(const char *p, const char *end)
+        {
+            auto q = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+            return (q != nullptr) ? q + 1 : end;
+        }
+
+        // true if [p, end) starts with 'token' followed by white space or end
+        inline bool isToken(const char *p, const char *end, const char *token)
+        {
+            auto n = std::strlen(token);
+            if (static_cast<std::size_t>(end - p) < n || std::memcmp(p, token, n) != 0) return false;
+            return p + n == end || isSpace(p[n]);
+        }
+
+        // Start of the first 'token' in [p, end) that is a whole word, i.e. is preceded
+        // by white space or 'begin' and followed by white space or end; end if none.
+        inline const char* findToken(const char *begin, const char *p, const char *end, const char *token)
+        {
+            auto n = std::strlen(token);
+            while (static_cast<std::size_t>(end - p) >= n)
+            {
+                auto q = static_cast<const char*>(std::memchr(p, token[0], static_cast<std::size_t>(end - p - n + 1)));
+                if (q == nullptr) break;
+                if ((q == begin || isSpace(q[-1])) && isToken(q, end, token)) return q;
+                p = q + 1;
+            }
+            return end;
+        }
+
+        // Decimal integer with optional sign. Values out of the range of I saturate to
+        // its minimum or maximum (negative values of unsigned types to 0), so callers
+        // with range limits of their own see an out of range value, never a wrapped one.
+        template<typename I>
+        inline const char* parseInt(const char *first, const char *end, I &value)
+        {
+            auto p = first;
+            bool negative = false;
+            if (p < end && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+            if (p == end || !isDigit(*p)) return first;
+            // magnitude limit: |min| when negative, max otherwise
+            auto limit = negative ? std::uint64_t(0) - static_cast<std::uint64_t>(std::numeric_limits<I>::min())
+                                  : static_cast<std::uint64_t>(std::numeric_limits<I>::max());
+            std::uint64_t v = 0;
+            for (; p < end && isDigit(*p); ++p)
+            {
+                auto d = static_cast<std::uint64_t>(*p - '0');
+                v = (v > limit / 10 || (v == limit / 10 && d > limit % 10)) ? limit : v * 10 + d;
+            }
+            value = (negative && v != 0) ? static_cast<I>(-static_cast<I>(v - 1) - 1) : static_cast<I>(v);
+            return p;
+        }
+
+        // Decimal floating point number: optional sign, digits with an optional point,
+        // optional exponent. The first 19 significant digits are kept; values whose
+        // digits fit a double exactly and whose exponent is within +-22 are correctly
+        // rounded (one multiply or divide by an exact power of ten). Longer mantissas
+        // with exponents within +-27 go through long double, which rounds them
+        // correctly but for rare double rounding cases where long double has a 64 bit
+        // mantissa (x86). Other values are within a few ulp, always close enough to
+        // round trip floats. Infinity and NaN are not accepted.
+        inline const char* parseReal(const char *first, const char *end, double &value)
+        {
+            static constexpr double powers[] = {
+                1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+            static constexpr long double longPowers[] = {
+                1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L, 1e8L, 1e9L, 1e10L, 1e11L, 1e12L, 1e13L,
+                1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L, 1e20L, 1e21L, 1e22L, 1e23L, 1e24L, 1e25L,
+                1e26L, 1e27L };
+
+            auto p = first;
+            bool negative = false;
+            if (p < end && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+
+            std::uint64_t mantissa = 0;
+            int digits = 0, exponent = 0;
+            bool any = false;
+            for (; p < end && isDigit(*p); ++p)
+            {
+                any = true;
+                if (digits < 19)
+                {
+                    mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+                    if (mantissa != 0) ++digits;
+                }
+                else ++exponent;
+            }
+            if (p < end && *p == '.')
+            {
+                for (++p; p < end && isDigit(*p); ++p)
+                {
+                    any = true;
+                    if (digits < 19)
+                    {
+                        mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+                        if (mantissa != 0) ++digits;
+                        --exponent;
+                    }
+                }
+            }
+            if (!any) return first;
+
+            if (p < end && (*p == 'e' || *p == 'E'))
+            {
+                std::int64_t e = 0;
+                auto q = parseInt(p + 1, end, e);
+                if (q != p + 1)
+                {
+                    exponent += static_cast<int>((e > 9999) ? 9999 : (e < -9999) ? -9999 : e);
+                    p = q;
+                }
+            }
+
+            double v;
+            if (mantissa == 0)
+                v = 0;
+            else if (exponent >= -22 && exponent <= 22 && mantissa <= (std::uint64_t(1) << 53))
+                v = (exponent < 0) ? static_cast<double>(mantissa) / powers[-exponent]
+                                   : static_cast<double>(mantissa) * powers[exponent];
+            else if (exponent >= -27 && exponent <= 27)
+            {
+                // a 64 bit long double mantissa holds the digits and the power exactly
+                long double m = static_cast<long double>(mantissa);
+                long double scale = longPowers[(exponent < 0) ? -exponent : exponent];
+                v = static_cast<double>((exponent < 0) ? m / scale : m * scale);
+            }
+            else
+                v = static_cast<double>(static_cast<long double>(mantissa) * std::pow(10.0L, exponent));
+            value = negative ? -v : v;
+            return p;
+        }
+
+        inline const char* parseReal(const char *first, const char *end, float &value)
+        {
+            double v;
+            auto p = parseReal(first, end, v);
+            if (p != first) value = static_cast<float>(v);
+            return p;
+        }
+
+        // Formatting helpers of the text mesh writers. They write to a caller provided
+        // buffer, return the position after the written text and are locale independent.
+
+        // decimal digits of 'value', at most 20 characters
+        inline char* formatUInt(char *out, std::uint64_t value)
+        {
+            char digits[20];
+            int n = 0;
+            do
+            {
+                digits[n++] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value != 0);
+            while (n > 0) *out++ = digits[--n];
+            return out;
+        }
+
+        // value * 10^k rounded to nearest even, for positive value, scaled in long double
+        inline std::uint64_t scaledDigits(double value, int k)
+        {
+            static constexpr long double powers[] = {
+                1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L, 1e8L, 1e9L, 1e10L, 1e11L, 1e12L, 1e13L,
+                1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L, 1e20L, 1e21L, 1e22L, 1e23L, 1e24L, 1e25L,
+                1e26L, 1e27L };
+            auto n = (k < 0) ? -k : k;
+            auto scale = (n <= 27) ? powers[n] : std::pow(10.0L, n);
+            auto s = (k < 0) ? value / scale : value * scale;
+            return static_cast<std::uint64_t>(std::llrint(s));
+        }
+
+        // 'value' with 'digits' (1 to 17) significant digits and no trailing zeros, in
+        // plain notation for decimal exponents -4 to digits - 1 and scientific notation
+        // otherwise, like printf %.*g. The digits are scaled in long double, not exactly:
+        // with a 64 bit mantissa (x86) they match printf's correctly rounded digits but
+        // for values lying right next to a half way point of the last digit, which is
+        // rare for decimal exponents within about +-27 and more frequent beyond, where
+        // the power of ten is itself rounded. The last digit is then one off, which
+        // still reads back exactly: 9 digits round trip every float, 17 every double.
+        // At most 25 characters; NaN and infinity as nan and inf.
+        inline char* formatReal(char *out, double value, int digits)
+        {
+            static constexpr std::uint64_t powers[] = {
+                1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+                100000000ull, 1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull,
+                10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+                100000000000000000ull };
+
+            if (std::isnan(value))
+            {
+                std::memcpy(out, "nan", 3);
+                return out + 3;
+            }
+            if (std::signbit(value))
+            {
+                *out++ = '-';
+                value = -value;
+            }
+            if (std::isinf(value))
+            {
+                std::memcpy(out, "inf", 3);
+                return out + 3;
+            }
+            if (value == 0)
+            {
+                *out++ = '0';
+                return out;
+            }
+
+            digits = (digits < 1) ? 1 : (digits > 17) ? 17 : digits;
+            auto e10 = static_cast<int>(std::floor(std::log10(value)));
+            auto m = scaledDigits(value, digits - 1 - e10);
+            // log10 may be off by one near powers of ten, and rounding may carry to 10^digits
+            if (m >= powers[digits]) m = scaledDigits(value, digits - 1 - ++e10);
+            else if (m < powers[digits - 1]) m = scaledDigits(value, digits - 1 - --e10);
+
+            auto n = digits;
+            while (n > 1 && m % 10 == 0)
+            {
+                m /= 10;
+                --n;
+            }
+            char d[20];
+            formatUInt(d, m);
+
+            if (e10 >= -4 && e10 < digits)
+            {
+                if (e10 < 0)
+                {
+                    *out++ = '0';
+                    *out++ = '.';
+                    for (int i = -1; i > e10; --i) *out++ = '0';
+                    std::memcpy(out, d, n);
+                    return out + n;
+                }
+                auto whole = e10 + 1;
+                if (whole >= n)
+                {
+                    std::memcpy(out, d, n);
+                    out += n;
+                    for (int i = n; i < whole; ++i) *out++ = '0';
+                    return out;
+                }
+                std::memcpy(out, d, whole);
+                out += whole;
+                *out++ = '.';
+                std::memcpy(out, d + whole, n - whole);
+                return out + (n - whole);
+            }
+
+            *out++ = d[0];
+            if (n > 1)
+            {
+                *out++ = '.';
+                std::memcpy(out, d + 1, n - 1);
+                out += n - 1;
+            }
+            *out++ = 'e';
+            if (e10 < 0)
+            {
+                *out++ = '-';
+                e10 = -e10;
+            }
+            return formatUInt(out, static_cast<std::uint64_t>(e10));
+        }
+    }
+}
+
+#endif
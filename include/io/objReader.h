@@ -0,0 +1,449 @@
+﻿#ifndef G3_IO_OBJ_READER
+#define G3_IO_OBJ_READER
+
+#include <cstddef>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <core/alignedAllocator.h>
+#include <core/gParallel.h>
+#include <core/memoryMappedFile.h>
+#include <math/vectorTraits.h>
+#include <math/indexType.h>
+#include <math/pointSet3.h>
+#include <io/ioUtil.h>
+
+namespace g3
+{
+    // Wavefront OBJ reader producing an indexed triangle mesh: positions and the
+    // optional normals as SoA point sets, UVs as two float arrays, triangles as Index3.
+    // The mapped file is split into one chunk of whole lines per thread and the chunks
+    // are parsed in parallel ('v', 'vn', 'vt' and 'f' lines; polygons are fanned into
+    // triangles, negative indices are relative). The chunk lists are then joined in
+    // file order. When every face corner uses the same index for its position, UV and
+    // normal (or leaves them out), the vertices are the 'v' lines; otherwise every
+    // distinct position/UV/normal combination becomes a vertex.
+    template<typename T>
+    class OBJReader
+    {
+    public:
+        using vector_type     = typename Vector3Traits<T>::vector_type;
+        using value_type      = typename vector_type::value_type;
+        using point_set_type  = PointSet3<T>;
+        using normal_type     = Vector3f;
+        using normal_set_type = PointSet3f;
+        using uv_type         = Vector2f;
+        using index_type      = Index3;
+        using self_type       = OBJReader<T>;
+
+        // constructors
+        OBJReader() : _threadCount(0) {}
+
+        // functions
+        // number of parsing threads, <= 0 means all hardware threads
+        int threadCount() const { return _threadCount; }
+        void setThreadCount(int n) { _threadCount = n; }
+
+        bool read(const std::string &path)
+        {
+            MemoryMappedFile file;
+            if (!file.open(path))
+            {
+                clear();
+                return false;
+            }
+            return read(file.data(), file.size());
+        }
+
+        // parse an OBJ file held in memory; false and an empty reader on malformed
+        // numbers or indices out of range
+        bool read(const void *data, std::size_t size)
+        {
+            clear();
+            auto text = static_cast<const char*>(data);
+            if (!parse(text, text + size))
+            {
+                clear();
+                return false;
+            }
+            return true;
+        }
+
+        void clear()
+        {
+            _positions.clear();
+            _normals.clear();
+            _u.clear();
+            _v.clear();
+            _triangles.clear();
+        }
+
+        std::size_t vertexCount() const { return _positions.size(); }
+        std::size_t triangleCount() const { return _triangles.size(); }
+
+        // set when faces reference normals / UVs, vertices without one get zero
+        bool hasVertexNormals() const { return _normals.size() != 0; }
+        bool hasVertexUVs() const { return !_u.empty(); }
+
+        const point_set_type& positions() const { return _positions; }
+        const normal_set_type& normals() const { return _normals; }
+        const float* dataU() const { return _u.data(); }
+        const float* dataV() const { return _v.data(); }
+        const std::vector<index_type>& triangles() const { return _triangles; }
+
+        vector_type getVertex(std::size_t vid) const { return _positions.get(vid); }
+        normal_type getVertexNormal(std::size_t vid) const { return _normals.get(vid); }
+        uv_type getVertexUV(std::size_t vid) const { return uv_type(_u[vid], _v[vid]); }
+
+    private:
+        // inputs smaller than this are parsed on the calling thread only
+        static const std::size_t parallelSize = 1 << 20;
+
+        // Face corner indices while parsing: 0 based absolute indices as they are,
+        // 'missing' for an absent UV or normal, and relative indices as the position
+        // within their own chunk minus 'relativeBase', resolved once the chunk offsets
+        // are known.
+        static constexpr std::int64_t missing = -1;
+        static constexpr std::int64_t relativeBase = std::int64_t(1) << 50;
+
+        struct Chunk
+        {
+            std::vector<vector_type> v;
+            std::vector<normal_type> vn;
+            std::vector<uv_type> vt;
+            // three (v, vt, vn) corners per triangle
+            std::vector<std::int64_t> corners;
+            bool ok = true;
+            bool anyUV = false, anyNormal = false;
+        };
+
+        static bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+        static const char* skipBlank(const char *p, const char *end)
+        {
+            while (p < end && isBlank(*p)) ++p;
+            return p;
+        }
+
+        template<typename V>
+        static bool parseVector(const char *p, const char *end, V &r, int required, int count)
+        {
+            for (int k = 0; k < count; ++k)
+            {
+                p = skipBlank(p, end);
+                auto q = ioUtil::parseReal(p, end, r[k]);
+                if (q == p)
+                {
+                    if (k < required) return false;
+                    for (; k < count; ++k) r[k] = 0;
+                    return true;
+                }
+                p = q;
+            }
+            return true;
+        }
+
+        static std::int64_t encode(std::int64_t index, std::size_t localCount)
+        {
+            if (index > 0) return index - 1;
+            return static_cast<std::int64_t>(localCount) + index - relativeBase;
+        }
+
+        // one index of a corner, e.g. the '12' of '3/12/7'; 0 is not a valid OBJ index
+        static const char* parseIndex(const char *p, const char *end, std::size_t localCount, std::int64_t &index, bool &ok)
+        {
+            std::int64_t i = 0;
+            auto q = ioUtil::parseInt(p, end, i);
+            // beyond +-relativeBase the encoding would overflow, no file gets near it
+            if (q == p || i == 0 || i >= relativeBase || i <= -relativeBase)
+            {
+                ok = false;
+                index = missing;
+                return q;
+            }
+            index = encode(i, localCount);
+            return q;
+        }
+
+        static void parseFace(const char *p, const char *end, Chunk &c)
+        {
+            std::int64_t first[3], previous[3];
+            int count = 0;
+            for (p = skipBlank(p, end); p < end && *p != '#'; p = skipBlank(p, end), ++count)
+            {
+                std::int64_t corner[3] = { missing, missing, missing };
+                p = parseIndex(p, end, c.v.size(), corner[0], c.ok);
+                if (p < end && *p == '/')
+                {
+                    if (++p < end && *p != '/') p = parseIndex(p, end, c.vt.size(), corner[1], c.ok);
+                    if (p < end && *p == '/') p = parseIndex(p + 1, end, c.vn.size(), corner[2], c.ok);
+                }
+                if (!c.ok || (p < end && !isBlank(*p)))
+                {
+                    c.ok = false;
+                    return;
+                }
+                c.anyUV |= (corner[1] != missing);
+                c.anyNormal |= (corner[2] != missing);
+
+                if (count == 0) std::copy(corner, corner + 3, first);
+                else if (count >= 2)
+                {
+                    c.corners.insert(c.corners.end(), first, first + 3);
+                    c.corners.insert(c.corners.end(), previous, previous + 3);
+                    c.corners.insert(c.corners.end(), corner, corner + 3);
+                }
+                std::copy(corner, corner + 3, previous);
+            }
+        }
+
+        static void parseChunk(const char *p, const char *end, Chunk &c)
+        {
+            while (p < end && c.ok)
+            {
+                auto lineEnd = ioUtil::skipLine(p, end);
+                auto q = ioUtil::skipSpace(p, lineEnd);
+                if (q < lineEnd && *q == 'v')
+                {
+                    if (ioUtil::isToken(q, lineEnd, "v"))
+                    {
+                        // 'v x y z [w]' or 'v x y z r g b', the rest is ignored
+                        vector_type v;
+                        c.ok = parseVector(q + 1, lineEnd, v, 3, 3);
+                        c.v.push_back(v);
+                    }
+                    else if (ioUtil::isToken(q, lineEnd, "vn"))
+                    {
+                        normal_type n;
+                        c.ok = parseVector(q + 2, lineEnd, n, 3, 3);
+                        c.vn.push_back(n);
+                    }
+                    else if (ioUtil::isToken(q, lineEnd, "vt"))
+                    {
+                        uv_type uv;
+                        c.ok = parseVector(q + 2, lineEnd, uv, 1, 2);
+                        c.vt.push_back(uv);
+                    }
+                }
+                else if (q < lineEnd && *q == 'f' && ioUtil::isToken(q, lineEnd, "f"))
+                {
+                    auto e = lineEnd;
+                    while (e > q && (e[-1] == '\n' || e[-1] == '\r')) --e;
+                    parseFace(q + 1, e, c);
+                }
+                p = lineEnd;
+            }
+        }
+
+        // global index of a parsed corner index, or 'missing' if out of range
+        static std::int64_t resolve(std::int64_t index, std::size_t offset, std::size_t total)
+        {
+            if (index == missing) return missing;
+            if (index < missing) index += relativeBase + static_cast<std::int64_t>(offset);
+            return (index >= 0 && index < static_cast<std::int64_t>(total)) ? index : missing - 1;
+        }
+
+        template<typename V>
+        static void join(std::vector<Chunk> &chunks, std::vector<V> Chunk::*list, std::vector<V> &all,
+                         const std::vector<std::size_t> &offsets)
+        {
+            all.resize(offsets.back());
+            gParallel::forBlocks(0, chunks.size(), static_cast<int>(chunks.size()),
+                [&](int, std::size_t b, std::size_t e)
+            {
+                for (auto i = b; i < e; ++i)
+                {
+                    auto &l = chunks[i].*list;
+                    std::copy(l.begin(), l.end(), all.begin() + offsets[i]);
+                    std::vector<V>().swap(l);
+                }
+            });
+        }
+
+        bool parse(const char *text, const char *end)
+        {
+            auto size = static_cast<std::size_t>(end - text);
+            int blocks = (size >= parallelSize) ? gParallel::resolveThreadCount(_threadCount) : 1;
+
+            // chunk starts: equal byte splits moved forward to the next line
+            std::vector<const char*> starts(blocks + 1, end);
+            starts[0] = text;
+            for (int i = 1; i < blocks; ++i)
+                starts[i] = std::max(starts[i - 1], ioUtil::skipLine(text + size / blocks * i - 1, end));
+
+            std::vector<Chunk> chunks(blocks);
+            gParallel::forBlocks(0, blocks, blocks, [&](int, std::size_t b, std::size_t e)
+            {
+                for (auto i = b; i < e; ++i) parseChunk(starts[i], starts[i + 1], chunks[i]);
+            });
+
+            std::vector<std::size_t> vOffsets(blocks + 1, 0), vtOffsets(blocks + 1, 0),
+                                     vnOffsets(blocks + 1, 0), cOffsets(blocks + 1, 0);
+            bool anyUV = false, anyNormal = false, aligned = true;
+            for (int i = 0; i < blocks; ++i)
+            {
+                const auto &c = chunks[i];
+                if (!c.ok) return false;
+                vOffsets[i + 1] = vOffsets[i] + c.v.size();
+                vtOffsets[i + 1] = vtOffsets[i] + c.vt.size();
+                vnOffsets[i + 1] = vnOffsets[i] + c.vn.size();
+                cOffsets[i + 1] = cOffsets[i] + c.corners.size();
+                anyUV |= c.anyUV;
+                anyNormal |= c.anyNormal;
+            }
+
+            // global corner indices, checking the range and whether all attributes
+            // of a corner share its position index
+            std::vector<std::int64_t> corners(cOffsets[blocks]);
+            std::vector<char> valid(blocks, 1), sameIndex(blocks, 1);
+            gParallel::forBlocks(0, blocks, blocks, [&](int, std::size_t b, std::size_t e)
+            {
+                for (auto i = b; i < e; ++i)
+                {
+                    const auto &cs = chunks[i].corners;
+                    auto out = corners.data() + cOffsets[i];
+                    for (std::size_t k = 0; k < cs.size(); k += 3)
+                    {
+                        out[k] = resolve(cs[k], vOffsets[i], vOffsets[blocks]);
+                        out[k + 1] = resolve(cs[k + 1], vtOffsets[i], vtOffsets[blocks]);
+                        out[k + 2] = resolve(cs[k + 2], vnOffsets[i], vnOffsets[blocks]);
+                        if (out[k] < 0 || out[k + 1] < missing || out[k + 2] < missing) valid[i] = 0;
+                        if ((out[k + 1] != missing && out[k + 1] != out[k]) ||
+                            (out[k + 2] != missing && out[k + 2] != out[k])) sameIndex[i] = 0;
+                    }
+                    std::vector<std::int64_t>().swap(chunks[i].corners);
+                }
+            });
+            for (int i = 0; i < blocks; ++i)
+            {
+                if (!valid[i]) return false;
+                aligned &= (sameIndex[i] != 0);
+            }
+
+            std::vector<vector_type> v;
+            std::vector<normal_type> vn;
+            std::vector<uv_type> vt;
+            join(chunks, &Chunk::v, v, vOffsets);
+            join(chunks, &Chunk::vn, vn, vnOffsets);
+            join(chunks, &Chunk::vt, vt, vtOffsets);
+
+            if (aligned) buildAligned(corners, v, vn, vt, anyUV, anyNormal);
+            else buildSplit(corners, v, vn, vt, anyUV, anyNormal);
+            return true;
+        }
+
+        // vertex i is 'v' line i, with UV and normal i where present
+        void buildAligned(const std::vector<std::int64_t> &corners, const std::vector<vector_type> &v,
+                          const std::vector<normal_type> &vn, const std::vector<uv_type> &vt,
+                          bool anyUV, bool anyNormal)
+        {
+            auto n = v.size();
+            _positions.gather(v);
+            if (anyNormal)
+            {
+                _normals.resize(n);
+                for (std::size_t i = 0; i < n; ++i) _normals.set(i, (i < vn.size()) ? vn[i] : normal_type::zero);
+            }
+            if (anyUV)
+            {
+                _u.resize(n);
+                _v.resize(n);
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    _u[i] = (i < vt.size()) ? vt[i].x() : 0.0f;
+                    _v[i] = (i < vt.size()) ? vt[i].y() : 0.0f;
+                }
+            }
+            _triangles.resize(corners.size() / 9);
+            for (std::size_t t = 0; t < _triangles.size(); ++t)
+                _triangles[t] = index_type(static_cast<Index::value_type>(corners[9 * t]),
+                                           static_cast<Index::value_type>(corners[9 * t + 3]),
+                                           static_cast<Index::value_type>(corners[9 * t + 6]));
+        }
+
+        // every distinct (v, vt, vn) corner becomes a vertex, in order of first use
+        void buildSplit(const std::vector<std::int64_t> &corners, const std::vector<vector_type> &v,
+                        const std::vector<normal_type> &vn, const std::vector<uv_type> &vt,
+                        bool anyUV, bool anyNormal)
+        {
+            const std::uint32_t empty = 0xffffffffu;
+            std::vector<std::int64_t> keys;
+            std::vector<std::uint32_t> table(1024, empty);
+            auto hash = [](const std::int64_t *k) -> std::uint64_t
+            {
+                auto h = static_cast<std::uint64_t>(k[0]) * 0x9e3779b97f4a7c15ull;
+                h ^= static_cast<std::uint64_t>(k[1] + 1) * 0xc2b2ae3d27d4eb4full;
+                h ^= static_cast<std::uint64_t>(k[2] + 1) * 0x165667b19e3779f9ull;
+                return h ^ (h >> 31);
+            };
+            auto find = [&](const std::int64_t *k) -> std::size_t
+            {
+                auto mask = table.size() - 1;
+                auto slot = static_cast<std::size_t>(hash(k)) & mask;
+                while (table[slot] != empty)
+                {
+                    auto o = keys.data() + 3 * std::size_t(table[slot]);
+                    if (o[0] == k[0] && o[1] == k[1] && o[2] == k[2]) break;
+                    slot = (slot + 1) & mask;
+                }
+                return slot;
+            };
+
+            std::vector<std::uint32_t> ids(corners.size() / 3);
+            for (std::size_t c = 0; c < ids.size(); ++c)
+            {
+                auto k = corners.data() + 3 * c;
+                auto slot = find(k);
+                if (table[slot] == empty)
+                {
+                    table[slot] = static_cast<std::uint32_t>(keys.size() / 3);
+                    keys.insert(keys.end(), k, k + 3);
+                    // grow to keep the load under one half
+                    if (keys.size() / 3 * 2 > table.size())
+                    {
+                        std::vector<std::uint32_t>(2 * table.size(), empty).swap(table);
+                        for (std::uint32_t i = 0; i < keys.size() / 3; ++i) table[find(keys.data() + 3 * std::size_t(i))] = i;
+                        slot = find(k);
+                    }
+                }
+                ids[c] = table[slot];
+            }
+
+            auto n = keys.size() / 3;
+            _positions.resize(n);
+            if (anyNormal) _normals.resize(n);
+            if (anyUV)
+            {
+                _u.resize(n);
+                _v.resize(n);
+            }
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                auto k = keys.data() + 3 * i;
+                _positions.set(i, v[k[0]]);
+                if (anyNormal) _normals.set(i, (k[2] != missing) ? vn[k[2]] : normal_type::zero);
+                if (anyUV)
+                {
+                    _u[i] = (k[1] != missing) ? vt[k[1]].x() : 0.0f;
+                    _v[i] = (k[1] != missing) ? vt[k[1]].y() : 0.0f;
+                }
+            }
+            _triangles.resize(ids.size() / 3);
+            for (std::size_t t = 0; t < _triangles.size(); ++t)
+                _triangles[t] = index_type(ids[3 * t], ids[3 * t + 1], ids[3 * t + 2]);
+        }
+
+        point_set_type _positions;
+        normal_set_type _normals;
+        std::vector<float, AlignedAllocator<float>> _u, _v;
+        std::vector<index_type> _triangles;
+        int _threadCount;
+    };
+
+    using OBJReaderd = OBJReader<double>;
+    using OBJReaderf = OBJReader<float>;
+}
+
+#endif
@@ -0,0 +1,169 @@
+﻿#ifndef G3_IO_OBJ_WRITER
+#define G3_IO_OBJ_WRITER
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <math/vectorTraits.h>
+#include <math/indexType.h>
+#include <math/pointSet3.h>
+#include <io/ioUtil.h>
+
+namespace g3
+{
+    // Wavefront OBJ writer for indexed triangle meshes with optional per vertex normals
+    // and UVs, which share the position index ('f a/a/a'). Numbers are formatted with
+    // ioUtil::formatReal into a fixed size buffer that is written out when full.
+    // Positions get 'digits' significant digits, by default enough to read back the
+    // exact values; normals and UVs get the 9 digits that round trip floats.
+    template<typename T>
+    class OBJWriter
+    {
+    public:
+        using vector_type    = typename Vector3Traits<T>::vector_type;
+        using value_type     = typename vector_type::value_type;
+        using point_set_type = PointSet3<T>;
+        using normal_type    = Vector3f;
+        using uv_type        = Vector2f;
+        using index_type     = Index3;
+
+        // static values
+        static constexpr int defaultDigits = std::numeric_limits<value_type>::max_digits10;
+
+        // static functions
+        static bool write(const std::string &path, const vector_type *vertices, std::size_t vertexCount,
+                          const index_type *triangles, std::size_t triangleCount,
+                          const normal_type *normals = nullptr, const uv_type *uvs = nullptr,
+                          int digits = defaultDigits)
+        {
+            return writeFile(path, vertexCount, triangles, triangleCount, digits,
+                [vertices](std::size_t i, int k) -> double { return vertices[i][k]; },
+                normals != nullptr, [normals](std::size_t i, int k) -> double { return normals[i][k]; },
+                uvs != nullptr, [uvs](std::size_t i, int k) -> double { return uvs[i][k]; });
+        }
+
+        static bool write(const std::string &path, const std::vector<vector_type> &vertices,
+                          const std::vector<index_type> &triangles, int digits = defaultDigits)
+        { return write(path, vertices.data(), vertices.size(), triangles.data(), triangles.size(), nullptr, nullptr, digits); }
+
+        // SoA form; 'u' and 'v' are both given or both nullptr
+        static bool write(const std::string &path, const point_set_type &positions,
+                          const std::vector<index_type> &triangles, const PointSet3f *normals = nullptr,
+                          const float *u = nullptr, const float *v = nullptr, int digits = defaultDigits)
+        {
+            auto px = positions.dataX(), py = positions.dataY(), pz = positions.dataZ();
+            const float *nx = nullptr, *ny = nullptr, *nz = nullptr;
+            if (normals != nullptr)
+            {
+                nx = normals->dataX();
+                ny = normals->dataY();
+                nz = normals->dataZ();
+            }
+            return writeFile(path, positions.size(), triangles.data(), triangles.size(), digits,
+                [px, py, pz](std::size_t i, int k) -> double { return (k == 0) ? px[i] : (k == 1) ? py[i] : pz[i]; },
+                normals != nullptr, [nx, ny, nz](std::size_t i, int k) -> double { return (k == 0) ? nx[i] : (k == 1) ? ny[i] : nz[i]; },
+                u != nullptr, [u, v](std::size_t i, int k) -> double { return (k == 0) ? u[i] : v[i]; });
+        }
+
+    private:
+        static const std::size_t bufferSize = 1 << 20;
+        // longest line: 'f', three corners ' a/b/c' of up to 20 digit (64 bit) ids, '\n';
+        // Index3 ids take at most 10 digits, the margin keeps wider index types safe
+        static const std::size_t lineReserve = 3 * (3 * 20 + 3) + 2;
+
+        // buffered output of whole lines
+        class Output
+        {
+        public:
+            Output(const std::string &path) : _file(path, std::ios::binary | std::ios::trunc), _buffer(bufferSize), _used(0) {}
+            ~Output() { flush(); }
+
+            bool good() const { return static_cast<bool>(_file); }
+
+            // space for one line
+            char* line()
+            {
+                if (_buffer.size() - _used < lineReserve) flush();
+                return _buffer.data() + _used;
+            }
+            void commit(char *end) { _used = static_cast<std::size_t>(end - _buffer.data()); }
+
+            void flush()
+            {
+                _file.write(_buffer.data(), static_cast<std::streamsize>(_used));
+                _used = 0;
+            }
+
+        private:
+            std::ofstream _file;
+            std::vector<char> _buffer;
+            std::size_t _used;
+        };
+
+        template<typename F>
+        static char* writeLine(char *out, const char *tag, int count, std::size_t i, const F &f, int digits)
+        {
+            while (*tag) *out++ = *tag++;
+            for (int k = 0; k < count; ++k)
+            {
+                *out++ = ' ';
+                out = ioUtil::formatReal(out, f(i, k), digits);
+            }
+            *out++ = '\n';
+            return out;
+        }
+
+        template<typename P, typename N, typename U>
+        static bool writeFile(const std::string &path, std::size_t vertexCount,
+                              const index_type *triangles, std::size_t triangleCount, int digits,
+                              const P &position, bool hasNormals, const N &normal, bool hasUVs, const U &uv)
+        {
+            Output out(path);
+            if (!out.good()) return false;
+
+            for (std::size_t i = 0; i < vertexCount; ++i)
+                out.commit(writeLine(out.line(), "v", 3, i, position, digits));
+            if (hasNormals)
+                for (std::size_t i = 0; i < vertexCount; ++i)
+                    out.commit(writeLine(out.line(), "vn", 3, i, normal, 9));
+            if (hasUVs)
+                for (std::size_t i = 0; i < vertexCount; ++i)
+                    out.commit(writeLine(out.line(), "vt", 2, i, uv, 9));
+
+            for (std::size_t t = 0; t < triangleCount; ++t)
+            {
+                auto p = out.line();
+                *p++ = 'f';
+                for (int j = 0; j < 3; ++j)
+                {
+                    auto id = static_cast<std::uint64_t>(triangles[t][j]) + 1;
+                    *p++ = ' ';
+                    p = ioUtil::formatUInt(p, id);
+                    if (hasUVs || hasNormals)
+                    {
+                        *p++ = '/';
+                        if (hasUVs) p = ioUtil::formatUInt(p, id);
+                        if (hasNormals)
+                        {
+                            *p++ = '/';
+                            p = ioUtil::formatUInt(p, id);
+                        }
+                    }
+                }
+                *p++ = '\n';
+                out.commit(p);
+            }
+            out.flush();
+            return out.good();
+        }
+    };
+
+    using OBJWriterd = OBJWriter<double>;
+    using OBJWriterf = OBJWriter<float>;
+}
+
+#endif
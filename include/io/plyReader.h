@@ -0,0 +1,633 @@
+﻿#ifndef G3_IO_PLY_READER
+#define G3_IO_PLY_READER
+
+#include <cstddef>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <core/gParallel.h>
+#include <core/memoryMappedFile.h>
+#include <math/vectorTraits.h>
+#include <math/indexType.h>
+#include <math/pointSet3.h>
+#include <io/ioUtil.h>
+
+namespace g3
+{
+    // Binary PLY reader (little and big endian) that only decodes what is asked for.
+    // open() maps the file and parses the header into elements and properties; the
+    // read functions then project single properties out of the element records with
+    // strided copies into SoA arrays, converting type and byte order on the way.
+    // Properties that are not requested are never touched, so reading the positions
+    // of a scan costs the same whatever else the vertices carry. Elements of fixed
+    // size records are located directly; records with lists are walked once to find
+    // where the following elements start. ASCII PLY is recognized but not read.
+    class PLYReader
+    {
+    public:
+        using index_type = Index3;
+        using self_type  = PLYReader;
+
+        enum Format
+        {
+            Unknown,
+            ASCII,
+            BinaryLittleEndian,
+            BinaryBigEndian
+        };
+
+        enum Type
+        {
+            InvalidType,
+            Int8,
+            UInt8,
+            Int16,
+            UInt16,
+            Int32,
+            UInt32,
+            Float32,
+            Float64
+        };
+
+        struct Property
+        {
+            std::string name;
+            Type type = InvalidType;
+            // lists: 'countType' items count, then that many 'type' items
+            bool isList = false;
+            Type countType = InvalidType;
+            // byte offset in the record, for elements of fixed size records
+            std::size_t offset = 0;
+        };
+
+        struct Element
+        {
+            std::string name;
+            std::size_t count = 0;
+            std::vector<Property> properties;
+            // record size, 0 if the records hold lists
+            std::size_t stride = 0;
+        };
+
+        // static functions
+        static std::size_t typeSize(Type type)
+        {
+            switch (type)
+            {
+            case Int8: case UInt8: return 1;
+            case Int16: case UInt16: return 2;
+            case Int32: case UInt32: case Float32: return 4;
+            case Float64: return 8;
+            default: return 0;
+            }
+        }
+
+        // constructors
+        PLYReader() : _data(nullptr), _size(0), _format(Unknown), _threadCount(0) {}
+
+        // functions
+        // number of decoding threads, <= 0 means all hardware threads
+        int threadCount() const { return _threadCount; }
+        void setThreadCount(int n) { _threadCount = n; }
+
+        bool open(const std::string &path)
+        {
+            close();
+            if (!_file.open(path)) return false;
+            if (!parseHeader(_file.data(), _file.size()))
+            {
+                close();
+                return false;
+            }
+            return true;
+        }
+
+        // parse a PLY file held in memory, which must outlive the reads
+        bool open(const void *data, std::size_t size)
+        {
+            close();
+            if (!parseHeader(static_cast<const unsigned char*>(data), size))
+            {
+                close();
+                return false;
+            }
+            return true;
+        }
+
+        void close()
+        {
+            _file.close();
+            _data = nullptr;
+            _size = 0;
+            _format = Unknown;
+            _elements.clear();
+            _offsets.clear();
+            _comments.clear();
+        }
+
+        bool isOpen() const { return _format != Unknown; }
+        Format format() const { return _format; }
+        const std::vector<Element>& elements() const { return _elements; }
+        const std::vector<std::string>& comments() const { return _comments; }
+
+        // element / property lookup, nullptr if absent
+        const Element* findElement(const std::string &name) const
+        {
+            for (const auto &e : _elements)
+                if (e.name == name) return &e;
+            return nullptr;
+        }
+
+        const Property* findProperty(const std::string &element, const std::string &name) const
+        {
+            auto e = findElement(element);
+            return (e != nullptr) ? findProperty(*e, name) : nullptr;
+        }
+
+        std::size_t elementCount(const std::string &element) const
+        {
+            auto e = findElement(element);
+            return (e != nullptr) ? e->count : 0;
+        }
+
+        // Scalar properties 'names' of an element of fixed size records, property j
+        // into outputs[j] (element count values each), in one pass over the records.
+        // False if a property is missing or a list, the records are not fixed size or
+        // the file is too short for them. The read functions below size their outputs
+        // only once these checks passed, and leave them untouched otherwise.
+        template<typename T>
+        bool readProperties(const std::string &element, const std::vector<std::string> &names, T *const *outputs)
+        {
+            Projection projection;
+            if (!project(element, names, projection)) return false;
+            decodeProjection(projection, outputs);
+            return true;
+        }
+
+        template<typename T>
+        bool readProperty(const std::string &element, const std::string &name, std::vector<T> &out)
+        {
+            Projection projection;
+            if (!project(element, { name }, projection)) return false;
+            out.resize(projection.count);
+            T *outputs[] = { out.data() };
+            decodeProjection(projection, outputs);
+            return true;
+        }
+
+        // vertex x, y, z
+        template<typename T>
+        bool readPositions(PointSet3<T> &positions)
+        { return readVectors("vertex", { "x", "y", "z" }, positions); }
+
+        // vertex nx, ny, nz
+        bool readNormals(PointSet3f &normals)
+        { return readVectors("vertex", { "nx", "ny", "nz" }, normals); }
+
+        // vertex red, green, blue scaled to [0, 1] for integer types
+        bool readColors(PointSet3f &colors)
+        {
+            if (!readVectors("vertex", { "red", "green", "blue" }, colors)) return false;
+            float *outputs[] = { colors.dataX(), colors.dataY(), colors.dataZ() };
+            auto type = findProperty("vertex", "red")->type;
+            float scale = (type == UInt8) ? 1.0f / 255 : (type == UInt16) ? 1.0f / 65535 : 1.0f;
+            for (int k = 0; k < 3; ++k)
+            {
+                auto c = outputs[k];
+                for (std::size_t i = 0; i < colors.size(); ++i) c[i] *= scale;
+            }
+            return true;
+        }
+
+        // face 'vertex_indices' (or 'vertex_index') lists, polygons fanned into triangles;
+        // false if an index is negative or not below the vertex count
+        bool readTriangles(std::vector<index_type> &triangles)
+        {
+            triangles.clear();
+            auto e = findElementIndex("face");
+            if (e < 0 || _format == ASCII) return false;
+            const auto &el = _elements[e];
+            auto list = findProperty(el, "vertex_indices");
+            if (list == nullptr) list = findProperty(el, "vertex_index");
+            if (list == nullptr || !list->isList) return false;
+            std::size_t begin;
+            if (!elementBegin(e, begin)) return false;
+            auto vertexCount = elementCount("vertex");
+            auto swap = needsSwap();
+
+            // all triangles in records of nothing but the list: fixed size, parallel
+            std::size_t stride = 0;
+            if (el.properties.size() == 1 && uniformLists(e, begin, 3, stride))
+            {
+                triangles.resize(el.count);
+                auto blocks = blockCount(el.count * stride);
+                std::vector<char> valid(static_cast<std::size_t>(blocks), 1);
+                auto records = _data + begin + typeSize(list->countType);
+                auto itemSize = typeSize(list->type);
+                gParallel::forBlocks(0, el.count, blocks, [&](int block, std::size_t b, std::size_t end)
+                {
+                    const std::size_t step = 4096;
+                    std::int64_t corner[3][step];
+                    for (auto s = b; s < end; s += step)
+                    {
+                        auto n = std::min(step, end - s);
+                        for (int j = 0; j < 3; ++j)
+                            decode(records + s * stride + j * itemSize, stride, list->type, swap, n, corner[j]);
+                        for (std::size_t i = 0; i < n; ++i)
+                        {
+                            if (!inRange(corner[0][i], vertexCount) || !inRange(corner[1][i], vertexCount) ||
+                                !inRange(corner[2][i], vertexCount)) valid[block] = 0;
+                            triangles[s + i] = index_type(static_cast<Index::value_type>(corner[0][i]),
+                                                          static_cast<Index::value_type>(corner[1][i]),
+                                                          static_cast<Index::value_type>(corner[2][i]));
+                        }
+                    }
+                });
+                if (std::count(valid.begin(), valid.end(), 0) != 0) return fail(triangles);
+                return true;
+            }
+
+            // general records: walk them, fanning every polygon; 'p' is a byte offset
+            auto p = begin;
+            triangles.reserve(el.count);
+            for (std::size_t r = 0; r < el.count; ++r)
+            {
+                for (const auto &prop : el.properties)
+                {
+                    if (!prop.isList)
+                    {
+                        if (typeSize(prop.type) > _size - p) return fail(triangles);
+                        p += typeSize(prop.type);
+                        continue;
+                    }
+                    std::int64_t n;
+                    auto countSize = typeSize(prop.countType), itemSize = typeSize(prop.type);
+                    if (countSize > _size - p) return fail(triangles);
+                    decode(_data + p, 0, prop.countType, swap, 1, &n);
+                    p += countSize;
+                    if (n < 0 || static_cast<std::uint64_t>(n) > (_size - p) / itemSize) return fail(triangles);
+                    if (&prop == list)
+                    {
+                        std::int64_t first = 0, previous = 0;
+                        for (std::int64_t k = 0; k < n; ++k)
+                        {
+                            std::int64_t id;
+                            decode(_data + p + k * itemSize, 0, prop.type, swap, 1, &id);
+                            if (!inRange(id, vertexCount)) return fail(triangles);
+                            if (k == 0) first = id;
+                            else if (k >= 2)
+                                triangles.emplace_back(static_cast<Index::value_type>(first),
+                                                       static_cast<Index::value_type>(previous),
+                                                       static_cast<Index::value_type>(id));
+                            previous = id;
+                        }
+                    }
+                    p += static_cast<std::size_t>(n) * itemSize;
+                }
+            }
+            return true;
+        }
+
+    private:
+        // requested scalar properties of an element, checked against the file size
+        struct Projection
+        {
+            std::size_t begin = 0;
+            std::size_t count = 0;
+            std::size_t stride = 0;
+            std::vector<const Property*> properties;
+        };
+
+        static const std::size_t unknownOffset = ~std::size_t(0);
+        // inputs smaller than this many bytes are decoded on the calling thread only
+        static const std::size_t parallelSize = 1 << 20;
+
+        static bool hostIsLittleEndian()
+        {
+            const std::uint16_t one = 1;
+            unsigned char first;
+            std::memcpy(&first, &one, 1);
+            return first == 1;
+        }
+
+        static bool inRange(std::int64_t id, std::size_t count)
+        { return id >= 0 && static_cast<std::uint64_t>(id) < count; }
+
+        static bool fail(std::vector<index_type> &triangles)
+        {
+            triangles.clear();
+            return false;
+        }
+
+        static Type parseType(const std::string &name)
+        {
+            if (name == "char" || name == "int8") return Int8;
+            if (name == "uchar" || name == "uint8") return UInt8;
+            if (name == "short" || name == "int16") return Int16;
+            if (name == "ushort" || name == "uint16") return UInt16;
+            if (name == "int" || name == "int32") return Int32;
+            if (name == "uint" || name == "uint32") return UInt32;
+            if (name == "float" || name == "float32") return Float32;
+            if (name == "double" || name == "float64") return Float64;
+            return InvalidType;
+        }
+
+        template<typename S>
+        static S load(const unsigned char *p, bool swap)
+        {
+            unsigned char b[sizeof(S)];
+            std::memcpy(b, p, sizeof(S));
+            if (swap) std::reverse(b, b + sizeof(S));
+            S v;
+            std::memcpy(&v, b, sizeof(S));
+            return v;
+        }
+
+        template<typename S, typename T>
+        static void decodeAs(const unsigned char *p, std::size_t stride, bool swap, std::size_t count, T *out)
+        {
+            if (swap)
+                for (std::size_t i = 0; i < count; ++i) out[i] = static_cast<T>(load<S>(p + i * stride, true));
+            else
+                for (std::size_t i = 0; i < count; ++i) out[i] = static_cast<T>(load<S>(p + i * stride, false));
+        }
+
+        // 'count' values of 'type' at p, p + stride, ... converted to T
+        template<typename T>
+        static void decode(const unsigned char *p, std::size_t stride, Type type, bool swap, std::size_t count, T *out)
+        {
+            switch (type)
+            {
+            case Int8: decodeAs<std::int8_t>(p, stride, swap, count, out); break;
+            case UInt8: decodeAs<std::uint8_t>(p, stride, swap, count, out); break;
+            case Int16: decodeAs<std::int16_t>(p, stride, swap, count, out); break;
+            case UInt16: decodeAs<std::uint16_t>(p, stride, swap, count, out); break;
+            case Int32: decodeAs<std::int32_t>(p, stride, swap, count, out); break;
+            case UInt32: decodeAs<std::uint32_t>(p, stride, swap, count, out); break;
+            case Float32: decodeAs<float>(p, stride, swap, count, out); break;
+            case Float64: decodeAs<double>(p, stride, swap, count, out); break;
+            default: break;
+            }
+        }
+
+        static const Property* findProperty(const Element &e, const std::string &name)
+        {
+            for (const auto &p : e.properties)
+                if (p.name == name) return &p;
+            return nullptr;
+        }
+
+        int findElementIndex(const std::string &name) const
+        {
+            for (std::size_t i = 0; i < _elements.size(); ++i)
+                if (_elements[i].name == name) return static_cast<int>(i);
+            return -1;
+        }
+
+        bool project(const std::string &element, const std::vector<std::string> &names, Projection &projection)
+        {
+            auto e = findElementIndex(element);
+            if (e < 0 || _format == ASCII) return false;
+            const auto &el = _elements[e];
+            if (el.stride == 0) return false;
+            for (const auto &n : names)
+            {
+                auto p = findProperty(el, n);
+                if (p == nullptr || p->isList) return false;
+                projection.properties.push_back(p);
+            }
+            if (!elementBegin(e, projection.begin) || el.count > (_size - projection.begin) / el.stride) return false;
+            projection.count = el.count;
+            projection.stride = el.stride;
+            return true;
+        }
+
+        template<typename T>
+        void decodeProjection(const Projection &projection, T *const *outputs) const
+        {
+            const auto &props = projection.properties;
+            auto records = _data + projection.begin;
+            auto stride = projection.stride;
+            auto swap = needsSwap();
+            gParallel::forBlocks(0, projection.count, blockCount(projection.count * stride),
+                [&](int, std::size_t b, std::size_t end)
+            {
+                // sub-blocks small enough that the records stay in cache across properties
+                const std::size_t step = 4096;
+                for (auto s = b; s < end; s += step)
+                {
+                    auto n = std::min(step, end - s);
+                    for (std::size_t j = 0; j < props.size(); ++j)
+                        decode(records + s * stride + props[j]->offset, stride, props[j]->type, swap, n, outputs[j] + s);
+                }
+            });
+        }
+
+        template<typename T>
+        bool readVectors(const std::string &element, const std::vector<std::string> &names, PointSet3<T> &out)
+        {
+            Projection projection;
+            if (!project(element, names, projection)) return false;
+            out.resize(projection.count);
+            T *outputs[] = { out.dataX(), out.dataY(), out.dataZ() };
+            decodeProjection(projection, outputs);
+            return true;
+        }
+
+        bool needsSwap() const
+        { return (_format == BinaryBigEndian) == hostIsLittleEndian(); }
+
+        int blockCount(std::size_t bytes) const
+        { return (bytes >= parallelSize) ? gParallel::resolveThreadCount(_threadCount) : 1; }
+
+        bool parseHeader(const unsigned char *data, std::size_t size)
+        {
+            auto text = reinterpret_cast<const char*>(data);
+            auto end = text + size;
+            auto p = ioUtil::skipSpace(text, end);
+            if (!ioUtil::isToken(p, end, "ply")) return false;
+
+            Format format = Unknown;
+            std::size_t headerSize = 0;
+            while (true)
+            {
+                p = ioUtil::skipLine(p, end);
+                if (p == end) return false;
+                auto lineEnd = ioUtil::skipLine(p, end);
+                std::vector<std::string> words;
+                for (auto q = ioUtil::skipSpace(p, lineEnd); q < lineEnd; q = ioUtil::skipSpace(q, lineEnd))
+                {
+                    auto w = ioUtil::skipToken(q, lineEnd);
+                    words.emplace_back(q, w);
+                    q = w;
+                }
+                if (words.empty()) continue;
+                const auto &key = words[0];
+                if (key == "end_header")
+                {
+                    // the data starts right after the header line's '\n'
+                    headerSize = static_cast<std::size_t>(lineEnd - text);
+                    _offsets.assign(_elements.size(), std::size_t(unknownOffset));
+                    if (!_elements.empty()) _offsets[0] = headerSize;
+                    break;
+                }
+                if (key == "format" && words.size() >= 2)
+                {
+                    if (words[1] == "ascii") format = ASCII;
+                    else if (words[1] == "binary_little_endian") format = BinaryLittleEndian;
+                    else if (words[1] == "binary_big_endian") format = BinaryBigEndian;
+                    else return false;
+                }
+                else if (key == "comment" || key == "obj_info")
+                {
+                    auto c = ioUtil::skipSpace(ioUtil::skipSpace(p, lineEnd) + key.size(), lineEnd);
+                    auto e = lineEnd;
+                    while (e > c && ioUtil::isSpace(e[-1])) --e;
+                    _comments.emplace_back(c, e);
+                }
+                else if (key == "element" && words.size() == 3)
+                {
+                    Element e;
+                    e.name = words[1];
+                    std::int64_t count = 0;
+                    auto digits = words[2].data(), digitsEnd = digits + words[2].size();
+                    if (ioUtil::parseInt(digits, digitsEnd, count) != digitsEnd || count < 0) return false;
+                    e.count = static_cast<std::size_t>(count);
+                    _elements.push_back(e);
+                }
+                else if (key == "property" && !_elements.empty())
+                {
+                    Property prop;
+                    if (words.size() == 5 && words[1] == "list")
+                    {
+                        prop.isList = true;
+                        prop.countType = parseType(words[2]);
+                        prop.type = parseType(words[3]);
+                        prop.name = words[4];
+                        if (prop.countType == InvalidType || prop.countType == Float32 || prop.countType == Float64)
+                            return false;
+                    }
+                    else if (words.size() == 3)
+                    {
+                        prop.type = parseType(words[1]);
+                        prop.name = words[2];
+                    }
+                    if (prop.type == InvalidType) return false;
+                    _elements.back().properties.push_back(prop);
+                }
+                else return false;
+            }
+            if (format == Unknown) return false;
+
+            // binary records take at least one byte per property (the count of a list),
+            // which bounds the element counts by the data size
+            auto dataSize = size - headerSize;
+            for (auto &e : _elements)
+            {
+                std::size_t offset = 0, minRecord = 0;
+                bool fixed = true;
+                for (auto &prop : e.properties)
+                {
+                    prop.offset = offset;
+                    offset += typeSize(prop.type);
+                    minRecord += typeSize(prop.isList ? prop.countType : prop.type);
+                    fixed &= !prop.isList;
+                }
+                e.stride = fixed ? offset : 0;
+                if (format != ASCII && e.count > dataSize / std::max(minRecord, std::size_t(1))) return false;
+            }
+            _data = data;
+            _size = size;
+            _format = format;
+            return true;
+        }
+
+        // true if every record of element 'e' is one list of 'length' items, with the
+        // record size in 'stride'; checked in parallel on the count of every record
+        bool uniformLists(int e, std::size_t begin, std::int64_t length, std::size_t &stride) const
+        {
+            const auto &el = _elements[e];
+            if (el.properties.size() != 1 || !el.properties[0].isList) return false;
+            const auto &prop = el.properties[0];
+            auto countSize = typeSize(prop.countType);
+            stride = countSize + static_cast<std::size_t>(length) * typeSize(prop.type);
+            if (el.count > (_size - begin) / stride) return false;
+            auto swap = needsSwap();
+            auto blocks = blockCount(el.count * stride);
+            std::vector<char> uniform(static_cast<std::size_t>(blocks), 1);
+            gParallel::forBlocks(0, el.count, blocks, [&](int block, std::size_t b, std::size_t end)
+            {
+                for (auto i = b; i < end; ++i)
+                {
+                    std::int64_t n;
+                    decode(_data + begin + i * stride, 0, prop.countType, swap, 1, &n);
+                    if (n != length)
+                    {
+                        uniform[block] = 0;
+                        return;
+                    }
+                }
+            });
+            return std::count(uniform.begin(), uniform.end(), 0) == 0;
+        }
+
+        // byte offset of element 'e', walking the records of list elements before it once
+        bool elementBegin(int e, std::size_t &begin)
+        {
+            if (_offsets[e] != unknownOffset)
+            {
+                begin = _offsets[e];
+                return true;
+            }
+            std::size_t previous;
+            if (e == 0 || !elementBegin(e - 1, previous)) return false;
+            const auto &el = _elements[e - 1];
+            std::size_t stride;
+            if (el.stride != 0)
+            {
+                if (el.count > (_size - previous) / el.stride) return false;
+                begin = previous + el.count * el.stride;
+            }
+            else if (uniformLists(e - 1, previous, 3, stride))
+                begin = previous + el.count * stride;
+            else
+            {
+                auto swap = needsSwap();
+                auto p = previous;
+                for (std::size_t r = 0; r < el.count; ++r)
+                    for (const auto &prop : el.properties)
+                    {
+                        if (!prop.isList)
+                        {
+                            p += typeSize(prop.type);
+                            continue;
+                        }
+                        auto countSize = typeSize(prop.countType);
+                        if (p > _size || countSize > _size - p) return false;
+                        std::int64_t n;
+                        decode(_data + p, 0, prop.countType, swap, 1, &n);
+                        if (n < 0) return false;
+                        p += countSize + static_cast<std::size_t>(n) * typeSize(prop.type);
+                    }
+                begin = p;
+            }
+            if (begin > _size) return false;
+            _offsets[e] = begin;
+            return true;
+        }
+
+        MemoryMappedFile _file;
+        const unsigned char *_data;
+        std::size_t _size;
+        Format _format;
+        std::vector<Element> _elements;
+        std::vector<std::size_t> _offsets;
+        std::vector<std::string> _comments;
+        int _threadCount;
+    };
+}
+
+#endif
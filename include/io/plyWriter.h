@@ -0,0 +1,143 @@
+﻿#ifndef G3_IO_PLY_WRITER
+#define G3_IO_PLY_WRITER
+
+#include <cstddef>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <math/vectorTraits.h>
+#include <math/indexType.h>
+#include <math/pointSet3.h>
+
+namespace g3
+{
+    // Binary little endian PLY writer for point sets and indexed triangle meshes.
+    // Vertices hold x, y, z (float or double, after T), optionally nx, ny, nz as float
+    // and red, green, blue as uchar from colors in [0, 1]; faces hold
+    // 'list uchar int vertex_indices'. Records are packed into a fixed size buffer
+    // that is written out when full.
+    template<typename T>
+    class PLYWriter
+    {
+    public:
+        using vector_type    = typename Vector3Traits<T>::vector_type;
+        using value_type     = typename vector_type::value_type;
+        using point_set_type = PointSet3<T>;
+        using index_type     = Index3;
+
+        // static functions
+        // SoA form; 'normals' and 'colors' hold positions.size() values when given
+        static bool write(const std::string &path, const point_set_type &positions,
+                          const std::vector<index_type> &triangles = std::vector<index_type>(),
+                          const PointSet3f *normals = nullptr, const PointSet3f *colors = nullptr,
+                          const std::string &comment = std::string())
+        {
+            auto px = positions.dataX(), py = positions.dataY(), pz = positions.dataZ();
+            return writeFile(path, positions.size(), triangles.data(), triangles.size(), comment,
+                [px, py, pz](std::size_t i, int k) -> value_type { return (k == 0) ? px[i] : (k == 1) ? py[i] : pz[i]; },
+                normals, colors);
+        }
+
+        static bool write(const std::string &path, const std::vector<vector_type> &vertices,
+                          const std::vector<index_type> &triangles = std::vector<index_type>(),
+                          const std::string &comment = std::string())
+        {
+            auto v = vertices.data();
+            return writeFile(path, vertices.size(), triangles.data(), triangles.size(), comment,
+                [v](std::size_t i, int k) -> value_type { return v[i][k]; }, nullptr, nullptr);
+        }
+
+    private:
+        static const std::size_t bufferSize = 1 << 20;
+        // largest record: three doubles, three floats and three bytes, or a triangle
+        static const std::size_t recordReserve = 64;
+
+        static bool hostIsLittleEndian()
+        {
+            const std::uint16_t one = 1;
+            unsigned char first;
+            std::memcpy(&first, &one, 1);
+            return first == 1;
+        }
+
+        template<typename S>
+        static unsigned char* store(unsigned char *out, S value, bool swap)
+        {
+            std::memcpy(out, &value, sizeof(S));
+            if (swap) std::reverse(out, out + sizeof(S));
+            return out + sizeof(S);
+        }
+
+        static unsigned char toByte(float c)
+        {
+            auto v = c * 255.0f + 0.5f;
+            return static_cast<unsigned char>((v <= 0.0f) ? 0.0f : (v >= 255.0f) ? 255.0f : v);
+        }
+
+        template<typename P>
+        static bool writeFile(const std::string &path, std::size_t vertexCount,
+                              const index_type *triangles, std::size_t triangleCount, const std::string &comment,
+                              const P &position, const PointSet3f *normals, const PointSet3f *colors)
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file) return false;
+
+            const char *real = std::is_same<value_type, double>::value ? "double" : "float";
+            file << "ply\nformat binary_little_endian 1.0\n";
+            if (!comment.empty()) file << "comment " << comment << "\n";
+            file << "element vertex " << vertexCount << "\n";
+            file << "property " << real << " x\nproperty " << real << " y\nproperty " << real << " z\n";
+            if (normals != nullptr) file << "property float nx\nproperty float ny\nproperty float nz\n";
+            if (colors != nullptr) file << "property uchar red\nproperty uchar green\nproperty uchar blue\n";
+            if (triangleCount > 0)
+                file << "element face " << triangleCount << "\nproperty list uchar int vertex_indices\n";
+            file << "end_header\n";
+
+            auto swap = !hostIsLittleEndian();
+            std::vector<unsigned char> buffer(bufferSize);
+            auto out = buffer.data();
+            auto flush = [&]()
+            {
+                file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(out - buffer.data()));
+                out = buffer.data();
+            };
+            auto reserve = [&]() { if (static_cast<std::size_t>(buffer.data() + buffer.size() - out) < recordReserve) flush(); };
+
+            for (std::size_t i = 0; i < vertexCount; ++i)
+            {
+                reserve();
+                for (int k = 0; k < 3; ++k) out = store(out, position(i, k), swap);
+                if (normals != nullptr)
+                {
+                    out = store(out, normals->dataX()[i], swap);
+                    out = store(out, normals->dataY()[i], swap);
+                    out = store(out, normals->dataZ()[i], swap);
+                }
+                if (colors != nullptr)
+                {
+                    *out++ = toByte(colors->dataX()[i]);
+                    *out++ = toByte(colors->dataY()[i]);
+                    *out++ = toByte(colors->dataZ()[i]);
+                }
+            }
+            for (std::size_t t = 0; t < triangleCount; ++t)
+            {
+                reserve();
+                *out++ = 3;
+                for (int j = 0; j < 3; ++j) out = store(out, static_cast<std::int32_t>(triangles[t][j]), swap);
+            }
+            flush();
+            return static_cast<bool>(file);
+        }
+    };
+
+    using PLYWriterd = PLYWriter<double>;
+    using PLYWriterf = PLYWriter<float>;
+}
+
+#endif
@@ -0,0 +1,348 @@
+﻿#ifndef G3_IO_STL_READER
+#define G3_IO_STL_READER
+
+#include <cstddef>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <core/gParallel.h>
+#include <core/memoryMappedFile.h>
+#include <math/vectorTraits.h>
+#include <math/indexType.h>
+#include <math/triangle3.h>
+#include <io/ioUtil.h>
+
+namespace g3
+{
+    // Binary and ASCII STL reader. The file is memory mapped and parsed straight into
+    // a triangle soup: three packed Vector3f per triangle plus the stored facet
+    // normals. Binary records are decoded in parallel blocks; ASCII text is split into
+    // one block per thread, each block starting at a 'facet' keyword, and the blocks
+    // are parsed in parallel and joined in file order. weld() turns the soup into an
+    // indexed mesh. Binary files are read as little endian, on little endian hosts.
+    class STLReader
+    {
+    public:
+        using vector_type   = Vector3f;
+        using index_type    = Index3;
+        using triangle_type = Triangle3<float>;
+        using self_type     = STLReader;
+
+        enum Format
+        {
+            Unknown,
+            Binary,
+            ASCII
+        };
+
+        // static values
+        static constexpr std::size_t binaryHeaderSize = 84;
+        static constexpr std::size_t binaryRecordSize = 50;
+
+        // static functions
+        // Hash weld of a triangle soup (three vertices per triangle) into unique vertices
+        // and indexed triangles, in order of first use. Positions match when they are
+        // bitwise equal, with -0 equal to 0. Triangles that collapse to an edge or a
+        // point are dropped if 'dropDegenerate' is set.
+        static void weld(const vector_type *soup, std::size_t triangleCount,
+                         std::vector<vector_type> &vertices, std::vector<index_type> &triangles,
+                         bool dropDegenerate = false)
+        {
+            const std::uint32_t empty = 0xffffffffu;
+            vertices.clear();
+            triangles.clear();
+            triangles.reserve(triangleCount);
+
+            // open addressing on vertex ids, grown to keep the load under one half
+            std::size_t capacity = 1024;
+            while (capacity < triangleCount) capacity <<= 1;
+            std::vector<std::uint32_t> table(capacity, empty);
+            auto insert = [&](std::uint32_t vid, std::uint64_t h)
+            {
+                auto mask = table.size() - 1;
+                auto slot = static_cast<std::size_t>(h) & mask;
+                while (table[slot] != empty) slot = (slot + 1) & mask;
+                table[slot] = vid;
+            };
+
+            for (std::size_t t = 0; t < triangleCount; ++t)
+            {
+                std::uint32_t ids[3];
+                for (int j = 0; j < 3; ++j)
+                {
+                    const auto &v = soup[3 * t + j];
+                    std::uint32_t key[3];
+                    positionKey(v, key);
+                    auto h = hashKey(key);
+                    auto mask = table.size() - 1;
+                    auto slot = static_cast<std::size_t>(h) & mask;
+                    for (;; slot = (slot + 1) & mask)
+                    {
+                        auto id = table[slot];
+                        if (id == empty)
+                        {
+                            id = static_cast<std::uint32_t>(vertices.size());
+                            vertices.push_back(v);
+                            table[slot] = id;
+                            if (2 * vertices.size() > table.size())
+                            {
+                                std::vector<std::uint32_t>(2 * table.size(), empty).swap(table);
+                                for (std::uint32_t i = 0; i < vertices.size(); ++i)
+                                {
+                                    positionKey(vertices[i], key);
+                                    insert(i, hashKey(key));
+                                }
+                            }
+                            ids[j] = id;
+                            break;
+                        }
+                        std::uint32_t other[3];
+                        positionKey(vertices[id], other);
+                        if (other[0] == key[0] && other[1] == key[1] && other[2] == key[2])
+                        {
+                            ids[j] = id;
+                            break;
+                        }
+                    }
+                }
+                if (dropDegenerate && (ids[0] == ids[1] || ids[1] == ids[2] || ids[2] == ids[0])) continue;
+                triangles.emplace_back(ids[0], ids[1], ids[2]);
+            }
+        }
+
+        // constructors
+        STLReader() : _format(Unknown), _threadCount(0) {}
+
+        // functions
+        // number of parsing threads, <= 0 means all hardware threads
+        int threadCount() const { return _threadCount; }
+        void setThreadCount(int n) { _threadCount = n; }
+
+        bool read(const std::string &path)
+        {
+            MemoryMappedFile file;
+            if (!file.open(path))
+            {
+                clear();
+                return false;
+            }
+            return read(file.data(), file.size());
+        }
+
+        // parse an STL file held in memory; false and an empty reader on malformed input
+        bool read(const void *data, std::size_t size)
+        {
+            clear();
+            auto bytes = static_cast<const unsigned char*>(data);
+            bool ok = false;
+            if (isBinary(bytes, size)) ok = readBinary(bytes, size);
+            else if (isASCII(bytes, size)) ok = readASCII(reinterpret_cast<const char*>(bytes), size);
+            if (!ok) clear();
+            return ok;
+        }
+
+        void clear()
+        {
+            _format = Unknown;
+            _name.clear();
+            _vertices.clear();
+            _normals.clear();
+            _attributes.clear();
+        }
+
+        Format format() const { return _format; }
+        // 'solid' name of an ASCII file, the 80 byte header of a binary file
+        const std::string& name() const { return _name; }
+
+        std::size_t triangleCount() const { return _normals.size(); }
+        // three vertices per triangle
+        const std::vector<vector_type>& vertices() const { return _vertices; }
+        // facet normals as stored in the file
+        const std::vector<vector_type>& normals() const { return _normals; }
+        // attribute byte count of every binary record, empty for ASCII files
+        const std::vector<std::uint16_t>& attributes() const { return _attributes; }
+
+        triangle_type getTriangle(std::size_t tid) const
+        { return triangle_type(_vertices[3 * tid], _vertices[3 * tid + 1], _vertices[3 * tid + 2]); }
+
+        void weld(std::vector<vector_type> &vertices, std::vector<index_type> &triangles,
+                  bool dropDegenerate = false) const
+        { weld(_vertices.data(), triangleCount(), vertices, triangles, dropDegenerate); }
+
+    private:
+        // inputs smaller than this are parsed on the calling thread only
+        static const std::size_t parallelSize = 1 << 20;
+
+        static void positionKey(const vector_type &v, std::uint32_t key[3])
+        {
+            std::memcpy(key, v.data(), 3 * sizeof(float));
+            for (int k = 0; k < 3; ++k)
+                if (key[k] == 0x80000000u) key[k] = 0;
+        }
+
+        static std::uint64_t hashKey(const std::uint32_t key[3])
+        {
+            auto h = ((std::uint64_t(key[0]) << 32) | key[1]) * 0x9e3779b97f4a7c15ull;
+            h ^= (h >> 29) ^ (std::uint64_t(key[2]) * 0xc2b2ae3d27d4eb4full);
+            return h ^ (h >> 32);
+        }
+
+        static std::uint32_t triangleCountOf(const unsigned char *bytes)
+        {
+            std::uint32_t n;
+            std::memcpy(&n, bytes + 80, sizeof(n));
+            return n;
+        }
+
+        // binary files may start with "solid" too, so the record count decides first
+        static bool isBinary(const unsigned char *bytes, std::size_t size)
+        {
+            if (size < binaryHeaderSize) return false;
+            auto expected = binaryHeaderSize + binaryRecordSize * std::uint64_t(triangleCountOf(bytes));
+            if (expected == size) return true;
+            return expected < size && !isASCII(bytes, size);
+        }
+
+        static bool isASCII(const unsigned char *bytes, std::size_t size)
+        {
+            auto text = reinterpret_cast<const char*>(bytes);
+            return ioUtil::isToken(ioUtil::skipSpace(text, text + size), text + size, "solid");
+        }
+
+        int blockCount(std::size_t size) const
+        { return (size >= parallelSize) ? gParallel::resolveThreadCount(_threadCount) : 1; }
+
+        bool readBinary(const unsigned char *bytes, std::size_t size)
+        {
+            auto header = reinterpret_cast<const char*>(bytes);
+            _name.assign(header, header + 80);
+            _name.resize(std::strlen(_name.c_str()));
+            std::size_t count = triangleCountOf(bytes);
+            _vertices.resize(3 * count);
+            _normals.resize(count);
+            _attributes.resize(count);
+            gParallel::forBlocks(0, count, blockCount(size), [&](int, std::size_t b, std::size_t e)
+            {
+                for (auto i = b; i < e; ++i)
+                {
+                    auto r = bytes + binaryHeaderSize + binaryRecordSize * i;
+                    std::memcpy(_normals[i].data(), r, 12);
+                    std::memcpy(_vertices[3 * i].data(), r + 12, 12);
+                    std::memcpy(_vertices[3 * i + 1].data(), r + 24, 12);
+                    std::memcpy(_vertices[3 * i + 2].data(), r + 36, 12);
+                    std::memcpy(&_attributes[i], r + 48, 2);
+                }
+            });
+            _format = Binary;
+            return true;
+        }
+
+        struct Block
+        {
+            std::vector<vector_type> vertices, normals;
+            bool ok = true;
+        };
+
+        // parse 'facet normal n n n outer loop vertex v v v (x3) endloop endfacet' at p
+        static const char* parseFacet(const char *p, const char *end, vector_type &normal, vector_type v[3])
+        {
+            auto expect = [end](const char *q, const char *token) -> const char*
+            {
+                q = ioUtil::skipSpace(q, end);
+                return ioUtil::isToken(q, end, token) ? q + std::strlen(token) : nullptr;
+            };
+            auto vec = [end](const char *q, vector_type &r) -> const char*
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    q = ioUtil::skipSpace(q, end);
+                    auto n = ioUtil::parseReal(q, end, r[k]);
+                    if (n == q) return nullptr;
+                    q = n;
+                }
+                return q;
+            };
+            if (!(p = expect(p, "facet")) || !(p = expect(p, "normal")) || !(p = vec(p, normal)) ||
+                !(p = expect(p, "outer")) || !(p = expect(p, "loop"))) return nullptr;
+            for (int j = 0; j < 3; ++j)
+                if (!(p = expect(p, "vertex")) || !(p = vec(p, v[j]))) return nullptr;
+            if (!(p = expect(p, "endloop")) || !(p = expect(p, "endfacet"))) return nullptr;
+            return p;
+        }
+
+        bool readASCII(const char *text, std::size_t size)
+        {
+            auto end = text + size;
+            auto p = ioUtil::skipToken(ioUtil::skipSpace(text, end), end);
+            auto nameEnd = p;
+            while (nameEnd < end && *nameEnd != '\n' && *nameEnd != '\r') ++nameEnd;
+            auto nameBegin = ioUtil::skipSpace(p, nameEnd);
+            while (nameEnd > nameBegin && ioUtil::isSpace(nameEnd[-1])) --nameEnd;
+            _name.assign(nameBegin, nameEnd);
+
+            // block starts: equal byte splits moved forward to the next 'facet'
+            auto body = ioUtil::findToken(text, nameEnd, end, "facet");
+            auto blocks = blockCount(size);
+            std::vector<const char*> starts(blocks + 1, end);
+            auto step = static_cast<std::size_t>(end - body) / blocks;
+            for (int i = 0; i < blocks; ++i)
+                starts[i] = (i == 0) ? body : ioUtil::findToken(text, body + i * step, end, "facet");
+
+            // every block parses the facets that start in it, reading on as far as needed
+            std::vector<Block> parsed(blocks);
+            gParallel::forBlocks(0, blocks, blocks, [&](int, std::size_t b, std::size_t e)
+            {
+                for (auto i = b; i < e; ++i)
+                {
+                    auto &block = parsed[i];
+                    auto limit = std::max(starts[i], starts[i + 1]);
+                    auto q = starts[i];
+                    while (q < limit)
+                    {
+                        vector_type n, v[3];
+                        q = parseFacet(q, end, n, v);
+                        if (q == nullptr)
+                        {
+                            block.ok = false;
+                            break;
+                        }
+                        block.normals.push_back(n);
+                        block.vertices.insert(block.vertices.end(), v, v + 3);
+                        // skips 'endsolid' and 'solid' lines of files holding several solids
+                        q = ioUtil::findToken(text, q, end, "facet");
+                    }
+                }
+            });
+
+            std::vector<std::size_t> offsets(blocks + 1, 0);
+            for (int i = 0; i < blocks; ++i)
+            {
+                if (!parsed[i].ok) return false;
+                offsets[i + 1] = offsets[i] + parsed[i].normals.size();
+            }
+            _normals.resize(offsets[blocks]);
+            _vertices.resize(3 * offsets[blocks]);
+            gParallel::forBlocks(0, blocks, blocks, [&](int, std::size_t b, std::size_t e)
+            {
+                for (auto i = b; i < e; ++i)
+                {
+                    std::copy(parsed[i].normals.begin(), parsed[i].normals.end(), _normals.begin() + offsets[i]);
+                    std::copy(parsed[i].vertices.begin(), parsed[i].vertices.end(), _vertices.begin() + 3 * offsets[i]);
+                }
+            });
+            _format = ASCII;
+            return true;
+        }
+
+        Format _format;
+        std::string _name;
+        std::vector<vector_type> _vertices, _normals;
+        std::vector<std::uint16_t> _attributes;
+        int _threadCount;
+    };
+}
+
+#endif
@@ -0,0 +1,172 @@
+﻿#ifndef G3_IO_STL_WRITER
+#define G3_IO_STL_WRITER
+
+#include <cstddef>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <math/vectorTraits.h>
+#include <math/indexType.h>
+#include <io/ioUtil.h>
+
+namespace g3
+{
+    // Binary and ASCII STL writer for triangle soups (three vertices per triangle) and
+    // indexed meshes. Facet normals are computed from the counter-clockwise winding.
+    // Output goes through a fixed size buffer, so writing never holds the whole file
+    // in memory. Binary files are written little endian, on little endian hosts, and
+    // hold at most 2^32 - 1 triangles. ASCII numbers are formatted independently of
+    // the locale; the writers return false for more triangles than that, or for
+    // ASCII vertices that are not finite, which STL readers do not accept.
+    class STLWriter
+    {
+    public:
+        using vector_type = Vector3f;
+        using index_type  = Index3;
+
+        // static functions
+        static bool writeBinary(const std::string &path, const vector_type *soup, std::size_t triangleCount,
+                                const std::string &header = std::string())
+        { return writeBinaryFile(path, triangleCount, header, SoupAccess{ soup }); }
+
+        static bool writeBinary(const std::string &path, const vector_type *vertices,
+                                const index_type *triangles, std::size_t triangleCount,
+                                const std::string &header = std::string())
+        { return writeBinaryFile(path, triangleCount, header, IndexedAccess{ vertices, triangles }); }
+
+        static bool writeBinary(const std::string &path, const std::vector<vector_type> &vertices,
+                                const std::vector<index_type> &triangles, const std::string &header = std::string())
+        { return writeBinary(path, vertices.data(), triangles.data(), triangles.size(), header); }
+
+        static bool writeASCII(const std::string &path, const vector_type *soup, std::size_t triangleCount,
+                               const std::string &name = std::string())
+        { return writeASCIIFile(path, triangleCount, name, SoupAccess{ soup }); }
+
+        static bool writeASCII(const std::string &path, const vector_type *vertices,
+                               const index_type *triangles, std::size_t triangleCount,
+                               const std::string &name = std::string())
+        { return writeASCIIFile(path, triangleCount, name, IndexedAccess{ vertices, triangles }); }
+
+        static bool writeASCII(const std::string &path, const std::vector<vector_type> &vertices,
+                               const std::vector<index_type> &triangles, const std::string &name = std::string())
+        { return writeASCII(path, vertices.data(), triangles.data(), triangles.size(), name); }
+
+    private:
+        static const std::size_t bufferSize = 1 << 20;
+
+        struct SoupAccess
+        {
+            const vector_type *soup;
+            const vector_type& operator () (std::size_t tid, int j) const { return soup[3 * tid + j]; }
+        };
+
+        struct IndexedAccess
+        {
+            const vector_type *vertices;
+            const index_type *triangles;
+            const vector_type& operator () (std::size_t tid, int j) const { return vertices[triangles[tid][j]]; }
+        };
+
+        // longest facet: 12 numbers of at most 15 characters (9 digits) and the keywords
+        static const std::size_t facetReserve = 512;
+
+        template<typename Access>
+        static vector_type facetNormal(const Access &v, std::size_t tid)
+        {
+            auto p0 = v(tid, 0);
+            return (v(tid, 1) - p0).cross(v(tid, 2) - p0).normalized();
+        }
+
+        static bool isFinite(const vector_type &v)
+        { return std::isfinite(v[0]) && std::isfinite(v[1]) && std::isfinite(v[2]); }
+
+        static char* writeText(char *out, const char *text)
+        {
+            while (*text) *out++ = *text++;
+            return out;
+        }
+
+        // ' x y z\n', 9 digits round trip every float
+        static char* writeVector(char *out, const vector_type &v)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                *out++ = ' ';
+                out = ioUtil::formatReal(out, v[k], 9);
+            }
+            *out++ = '\n';
+            return out;
+        }
+
+        template<typename Access>
+        static bool writeBinaryFile(const std::string &path, std::size_t triangleCount,
+                                    const std::string &header, const Access &v)
+        {
+            if (triangleCount > std::numeric_limits<std::uint32_t>::max()) return false;
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file) return false;
+
+            char head[80] = {};
+            std::memcpy(head, header.data(), std::min(header.size(), sizeof(head)));
+            auto count = static_cast<std::uint32_t>(triangleCount);
+            file.write(head, sizeof(head));
+            file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+            const std::size_t recordSize = 50, perBuffer = bufferSize / recordSize;
+            std::vector<char> buffer(perBuffer * recordSize);
+            for (std::size_t begin = 0; begin < triangleCount; begin += perBuffer)
+            {
+                auto n = std::min(perBuffer, triangleCount - begin);
+                auto r = buffer.data();
+                for (auto i = begin; i < begin + n; ++i, r += recordSize)
+                {
+                    auto normal = facetNormal(v, i);
+                    std::memcpy(r, normal.data(), 12);
+                    for (int j = 0; j < 3; ++j) std::memcpy(r + 12 + 12 * j, v(i, j).data(), 12);
+                    r[48] = r[49] = 0;
+                }
+                file.write(buffer.data(), static_cast<std::streamsize>(n * recordSize));
+            }
+            return static_cast<bool>(file);
+        }
+
+        template<typename Access>
+        static bool writeASCIIFile(const std::string &path, std::size_t triangleCount,
+                                   const std::string &name, const Access &v)
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file) return false;
+
+            std::vector<char> buffer(bufferSize);
+            std::size_t used = 0;
+            auto flush = [&]() { file.write(buffer.data(), static_cast<std::streamsize>(used)); used = 0; };
+
+            file << "solid " << name << "\n";
+            for (std::size_t i = 0; i < triangleCount; ++i)
+            {
+                if (buffer.size() - used < facetReserve) flush();
+                auto out = buffer.data() + used;
+                if (!isFinite(v(i, 0)) || !isFinite(v(i, 1)) || !isFinite(v(i, 2))) return false;
+                // overflowing cross products of huge coordinates get the zero normal
+                auto n = facetNormal(v, i);
+                if (!isFinite(n)) n = vector_type::zero;
+                out = writeVector(writeText(out, "facet normal"), n);
+                out = writeText(out, " outer loop\n");
+                for (int j = 0; j < 3; ++j) out = writeVector(writeText(out, "  vertex"), v(i, j));
+                out = writeText(out, " endloop\nendfacet\n");
+                used = static_cast<std::size_t>(out - buffer.data());
+            }
+            flush();
+            file << "endsolid " << name << "\n";
+            return static_cast<bool>(file);
+        }
+    };
+}
+
+#endif
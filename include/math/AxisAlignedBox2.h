@@ -201,8 +201,12 @@ namespace g3
         bool contains(const self_type &box) const
         { return contains(box._min) && contains(box._max); }
 
-        bool intersects(const self_type &box)
-        { return intersect(box).valid(); }
+        // same result as intersect(box).valid(), without building the intersection
+        bool intersects(const self_type &box) const
+        {
+            return (_min.x() <= box._max.x()) && (box._min.x() <= _max.x()) &&
+                   (_min.y() <= box._max.y()) && (box._min.y() <= _max.y());
+        }
 
         value_type distance(const vector_type &v) const
         {
@@ -164,9 +164,15 @@ namespace g3
         }
 
         bool contains(const self_type &box) const
-        { return contains(_min) && contains(_max); }
+        { return contains(box._min) && contains(box._max); }
 
-        bool intersects(const self_type &box) const { return intersect(box).valid(); }
+        // same result as intersect(box).valid(), without building the intersection
+        bool intersects(const self_type &box) const
+        {
+            return (_min.x() <= box._max.x()) && (box._min.x() <= _max.x()) &&
+                   (_min.y() <= box._max.y()) && (box._min.y() <= _max.y()) &&
+                   (_min.z() <= box._max.z()) && (box._min.z() <= _max.z());
+        }
 
         value_type distanceSquared(const vector_type &v) const
         {
@@ -0,0 +1,178 @@
+﻿#ifndef G3_MATH_AXIS_ALIGNED_BOX_SET_3
+#define G3_MATH_AXIS_ALIGNED_BOX_SET_3
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <type_traits>
+
+#include <core/alignedAllocator.h>
+#include <math/vectorTraits.h>
+#include <math/AxisAlignedBox3.h>
+
+namespace g3
+{
+    // Structure-of-arrays storage for axis aligned boxes: the six bounds live in
+    // separate aligned arrays, so testing one box against all of them is a branch
+    // free unit-stride loop that the compiler turns into SIMD min/max compares.
+    // Overlap has the same meaning as AxisAlignedBox3::intersects (touching counts).
+    template<typename T>
+    class AxisAlignedBoxSet3
+    {
+        static_assert(std::is_arithmetic<T>::value, "AxisAlignedBoxSet3 requires an arithmetic type");
+
+    public:
+        using vector_type    = typename Vector3Traits<T>::vector_type;
+        using value_type     = typename vector_type::value_type;
+        using box_type       = AxisAlignedBox3<T>;
+        using allocator_type = AlignedAllocator<value_type>;
+        using array_type     = std::vector<value_type, allocator_type>;
+        using self_type      = AxisAlignedBoxSet3<T>;
+
+        // static values
+        static const std::size_t blockSize = 64;   // boxes per mask word
+
+        // static functions
+        static std::size_t maskWordCount(std::size_t count)
+        { return (count + blockSize - 1) / blockSize; }
+
+        // constructors
+        AxisAlignedBoxSet3() {}
+        AxisAlignedBoxSet3(const box_type *boxes, std::size_t count) { gather(boxes, count); }
+        AxisAlignedBoxSet3(const std::vector<box_type> &boxes) { gather(boxes); }
+
+        // functions
+        std::size_t size() const { return _minX.size(); }
+        bool empty() const { return _minX.empty(); }
+
+        void resize(std::size_t count)
+        {
+            _minX.resize(count); _minY.resize(count); _minZ.resize(count);
+            _maxX.resize(count); _maxY.resize(count); _maxZ.resize(count);
+        }
+
+        void reserve(std::size_t count)
+        {
+            _minX.reserve(count); _minY.reserve(count); _minZ.reserve(count);
+            _maxX.reserve(count); _maxY.reserve(count); _maxZ.reserve(count);
+        }
+
+        void clear()
+        {
+            _minX.clear(); _minY.clear(); _minZ.clear();
+            _maxX.clear(); _maxY.clear(); _maxZ.clear();
+        }
+
+        void append(const box_type &box)
+        {
+            auto bmin = box.minCoordinate(), bmax = box.maxCoordinate();
+            _minX.push_back(bmin.x()); _minY.push_back(bmin.y()); _minZ.push_back(bmin.z());
+            _maxX.push_back(bmax.x()); _maxY.push_back(bmax.y()); _maxZ.push_back(bmax.z());
+        }
+
+        box_type get(std::size_t i) const
+        { return box_type(_minX[i], _minY[i], _minZ[i], _maxX[i], _maxY[i], _maxZ[i]); }
+
+        void set(std::size_t i, const box_type &box)
+        {
+            auto bmin = box.minCoordinate(), bmax = box.maxCoordinate();
+            _minX[i] = bmin.x(); _minY[i] = bmin.y(); _minZ[i] = bmin.z();
+            _maxX[i] = bmax.x(); _maxY[i] = bmax.y(); _maxZ[i] = bmax.z();
+        }
+
+        const value_type* dataMinX() const { return _minX.data(); }
+        const value_type* dataMinY() const { return _minY.data(); }
+        const value_type* dataMinZ() const { return _minZ.data(); }
+        const value_type* dataMaxX() const { return _maxX.data(); }
+        const value_type* dataMaxY() const { return _maxY.data(); }
+        const value_type* dataMaxZ() const { return _maxZ.data(); }
+
+        // AoS -> SoA
+        void gather(const box_type *boxes, std::size_t count)
+        {
+            resize(count);
+            for (std::size_t i = 0; i < count; ++i) set(i, boxes[i]);
+        }
+
+        void gather(const std::vector<box_type> &boxes)
+        { gather(boxes.data(), boxes.size()); }
+
+        // Bit i % 64 of mask[i / 64] is set if box i overlaps 'box'. 'mask' must hold
+        // maskWordCount(size()) words; unused bits of the last word are cleared.
+        void overlaps(const box_type &box, std::uint64_t *mask) const
+        {
+            auto n = size();
+            unsigned char hit[blockSize];
+            for (std::size_t begin = 0; begin < n; begin += blockSize)
+            {
+                auto count = (n - begin < blockSize) ? n - begin : blockSize;
+                testBlock(box, begin, count, hit);
+                std::uint64_t word = 0;
+                for (std::size_t j = 0; j < count; ++j)
+                    word |= static_cast<std::uint64_t>(hit[j]) << j;
+                mask[begin / blockSize] = word;
+            }
+        }
+
+        void overlaps(const box_type &box, std::vector<std::uint64_t> &mask) const
+        {
+            mask.resize(maskWordCount(size()));
+            overlaps(box, mask.data());
+        }
+
+        // Writes the indices of the boxes overlapping 'box' in increasing order and returns
+        // their number. 'indices' must hold size() values.
+        std::size_t overlapIndices(const box_type &box, std::uint32_t *indices) const
+        {
+            auto n = size();
+            std::size_t found = 0;
+            unsigned char hit[blockSize];
+            for (std::size_t begin = 0; begin < n; begin += blockSize)
+            {
+                auto count = (n - begin < blockSize) ? n - begin : blockSize;
+                testBlock(box, begin, count, hit);
+                // branch free compaction: always write, only advance on a hit
+                for (std::size_t j = 0; j < count; ++j)
+                {
+                    indices[found] = static_cast<std::uint32_t>(begin + j);
+                    found += hit[j];
+                }
+            }
+            return found;
+        }
+
+        void overlapIndices(const box_type &box, std::vector<std::uint32_t> &indices) const
+        {
+            indices.resize(size());
+            indices.resize(overlapIndices(box, indices.data()));
+        }
+
+        // operator functions
+        box_type operator [] (std::size_t i) const
+        { return get(i); }
+
+    private:
+        void testBlock(const box_type &box, std::size_t begin, std::size_t count, unsigned char *hit) const
+        {
+            auto bmin = box.minCoordinate(), bmax = box.maxCoordinate();
+            auto qMinX = bmin.x(), qMinY = bmin.y(), qMinZ = bmin.z();
+            auto qMaxX = bmax.x(), qMaxY = bmax.y(), qMaxZ = bmax.z();
+            const value_type *minX = _minX.data() + begin, *minY = _minY.data() + begin, *minZ = _minZ.data() + begin;
+            const value_type *maxX = _maxX.data() + begin, *maxY = _maxY.data() + begin, *maxZ = _maxZ.data() + begin;
+            for (std::size_t j = 0; j < count; ++j)
+            {
+                hit[j] = static_cast<unsigned char>((minX[j] <= qMaxX) & (qMinX <= maxX[j]) &
+                                                    (minY[j] <= qMaxY) & (qMinY <= maxY[j]) &
+                                                    (minZ[j] <= qMaxZ) & (qMinZ <= maxZ[j]));
+            }
+        }
+
+        array_type _minX, _minY, _minZ;
+        array_type _maxX, _maxY, _maxZ;
+    };
+
+    using AxisAlignedBoxSet3d = AxisAlignedBoxSet3<double>;
+    using AxisAlignedBoxSet3f = AxisAlignedBoxSet3<float>;
+}
+
+#endif
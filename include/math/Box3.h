@@ -1,6 +1,7 @@
 ﻿#ifndef G3_MATH_BOX_3
 #define G3_MATH_BOX_3
 
+#include <cmath>
 #include <array>
 #include <vector>
 
@@ -15,7 +16,7 @@ namespace g3
     class Box3
     {
     public:
-        using vector_type = Vector3Traits<T>::vector_type;
+        using vector_type = typename Vector3Traits<T>::vector_type;
         using value_type = typename vector_type::value_type;
         using aab3_type = AxisAlignedBox3<T>;
         using self_type = Box3<T>;
@@ -27,10 +28,10 @@ namespace g3
         // static functions
 
         // ported from WildMagic5 Wm5ContBox3.cpp::MergeBoxes
-        self_type merge(const self_type &box0, const self_type &box1)
+        static self_type merge(const self_type &box0, const self_type &box1)
         {
             // Construct a box that contains the input boxes.
-            self_type box;
+            self_type box(vector_type::zero);
             // The first guess at the box center.  This value will be updated later
             // after the input box vertices are projected onto axes determined by an
             // average of box axes.
@@ -110,19 +111,19 @@ namespace g3
 
         // constructors
         Box3(const vector_type &center) : _center(center),
-            _axisX(vector_type::axisX), _axisY(vector_type::axisY), _axisZ(vector_type::axisZ)
+            _axisX(vector_type::axisX), _axisY(vector_type::axisY), _axisZ(vector_type::axisZ),
             _extent(vector_type::zero) {}
 
         Box3(const vector_type &center, 
             const vector_type &x, const vector_type &y, const vector_type &z, 
             const vector_type &extent) : _center(center), _axisX(x), _axisY(y), _axisZ(z), _extent(extent) {}
 
-        Box3(const vector_type &center, const vector_type &extent) : _center(center), _extent(extent),
-            _axisX(vector_type::axisX), _axisY(vector_type::axisY), _axisZ(vector_type::axisZ) {}
+        Box3(const vector_type &center, const vector_type &extent) : _center(center),
+            _axisX(vector_type::axisX), _axisY(vector_type::axisY), _axisZ(vector_type::axisZ), _extent(extent) {}
 
         Box3(const aab3_type &aab) : _axisX(vector_type::axisX), _axisY(vector_type::axisY), _axisZ(vector_type::axisZ)
         {
-            _extent = aab.extents() * (value_type)0.5;
+            _extent = aab.extents();
             _center = aab.center();
         }
 
@@ -225,7 +226,7 @@ namespace g3
             auto lv = v - _center;
             for (int i = 0; i < 3; ++i)
             {
-                auto t - lv.dot(axis(i));
+                auto t = lv.dot(axis(i));
                 if (std::abs(t) > _extent[i])
                 {
                     auto min = -_extent[i], max = _extent[i];
@@ -309,6 +310,59 @@ namespace g3
         void scaleExtent(const vector_type &s)
         { _extent = _extent * s; }
 
+        // Separating axis test against another oriented box: the 3 face axes of each box
+        // and the 9 edge cross products, with early out. Touching boxes overlap.
+        // Ported from Gottschalk et al. "OBBTree" / Ericson, Real-Time Collision Detection 4.4.1
+        bool intersects(const self_type &box) const
+        { return intersects(box, 0); }
+
+        // same as intersects(box) with this box grown by 'pad' along its own axes
+        bool intersects(const self_type &box, value_type pad) const
+        {
+            // rotation expressing 'box' in the frame of this box, and its absolute value;
+            // epsilon keeps near parallel edge pairs from producing a bogus separating axis
+            value_type r[3][3], absR[3][3];
+            for (int i = 0; i < 3; ++i)
+                for (int j = 0; j < 3; ++j)
+                {
+                    r[i][j] = axis(i).dot(box.axis(j));
+                    absR[i][j] = std::abs(r[i][j]) + mathUtil::getEpsilon<value_type>();
+                }
+
+            auto d = box._center - _center;
+            value_type t[3] = { d.dot(_axisX), d.dot(_axisY), d.dot(_axisZ) };
+            value_type a[3] = { _extent[0] + pad, _extent[1] + pad, _extent[2] + pad };
+            value_type b[3] = { box._extent[0], box._extent[1], box._extent[2] };
+
+            // axes of this box
+            for (int i = 0; i < 3; ++i)
+            {
+                auto rb = b[0] * absR[i][0] + b[1] * absR[i][1] + b[2] * absR[i][2];
+                if (std::abs(t[i]) > a[i] + rb) return false;
+            }
+
+            // axes of 'box'
+            for (int j = 0; j < 3; ++j)
+            {
+                auto ra = a[0] * absR[0][j] + a[1] * absR[1][j] + a[2] * absR[2][j];
+                if (std::abs(t[0] * r[0][j] + t[1] * r[1][j] + t[2] * r[2][j]) > ra + b[j]) return false;
+            }
+
+            // axis(i) x box.axis(j)
+            for (int i = 0; i < 3; ++i)
+            {
+                int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+                for (int j = 0; j < 3; ++j)
+                {
+                    int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+                    auto ra = a[i1] * absR[i2][j] + a[i2] * absR[i1][j];
+                    auto rb = b[j1] * absR[i][j2] + b[j2] * absR[i][j1];
+                    if (std::abs(t[i2] * r[i1][j] - t[i1] * r[i2][j]) > ra + rb) return false;
+                }
+            }
+            return true;
+        }
+
         // Returns distance to box, or 0 if point is inside box.
         // Ported from WildMagic5 Wm5DistPoint3Box3.cpp
         value_type distanceSquared(const vector_type &v) const
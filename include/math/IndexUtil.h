@@ -1,48 +1,169 @@
 ﻿#ifndef G3_MATH_INDEX_UTIL
 #define G3_MATH_INDEX_UTIL
 
+#include <cstddef>
+#include <vector>
+
 #include <math/indexType.h>
 
 namespace g3
 {
     namespace IndexUtil
     {
-        // TODO: review the codes of origin project geometry3Sharp and think over
-        //       wether the functions are necessary or not.
-        //       (may add new types triangle, edge, vertex_dege, triangle_edge
-        //       for class DMesh3.)
-
-        //// test if [a0,a1] and [b0,b1] are the same pair, ignoring order
-        //inline bool same_pair_unordered(const Index &a0, const Index &a1,
-        //                              const Index &b0, const Index &b1)
-        //{ return (a0 == b0 && a1 == b1) || (a0 == b1 && a1 == b0); }
-
-        //// find the vtx that is the same in both ev0 and ev1
-        //inline Index find_shared_edge_v(const Index2 &ev0, const Index2 &ev1)
-        //{
-        //    for (int i0 = 0; i0 < Index2::num; ++i0)
-        //        for (int i1 = 0; i1 < Index2::num; ++i1)
-        //            if (ev0[i0] == ev1[i1]) return ev0[i0];
-        //    return Index::invalidValue;  // return invalid index
-        //}
-
-        //// find the other vtx that in the same edge
-        //inline Index find_edge_other_v(const Index2 &ev, const Index &v)
-        //{
-        //    if (ev[0] == v) return ev[1];
-        //    else if (ev[1] == v) return ev[0];
-        //    else return Index::invalidValue;
-        //}
-
-        //// return index of v in tri_verts, or InvalidID if not found
-        //inline Index find_tri_index(const Index &v, const Index3 &tri_verts)
-        //{
-        //    for (int i = 0; i < Index3::num; ++i)
-        //        if (tri_verts[i] == v) return Index(i);
-        //    return Index::invalidValue;
-        //}
-
-        //// return index of e in tri_verts, or InvalidID if not found
+        // Topology primitives for Index2 edges and Index3 triangles, after g3Sharp
+        // IndexUtil. The fixed arity is unrolled into compares and selects so the
+        // compiler emits conditional moves instead of loops with early exits.
+        // Functions returning Index give Index::invalidValue when nothing matches.
+
+        // test if [a0,a1] and [b0,b1] are the same pair, ignoring order
+        inline bool same_pair_unordered(Index a0, Index a1, Index b0, Index b1)
+        { return ((a0 == b0) & (a1 == b1)) | ((a0 == b1) & (a1 == b0)); }
+
+        // find the vtx that is the same in both ev0 and ev1
+        inline Index find_shared_edge_v(const Index2 &ev0, const Index2 &ev1)
+        {
+            Index::value_type a0 = ev0[0], a1 = ev0[1], b0 = ev1[0], b1 = ev1[1];
+            auto r = ((a1 == b0) | (a1 == b1)) ? a1 : Index::invalidValue;
+            return ((a0 == b0) | (a0 == b1)) ? a0 : r;
+        }
+
+        // find the other vtx that in the same edge
+        inline Index find_edge_other_v(const Index2 &ev, Index v)
+        {
+            Index::value_type e0 = ev[0], e1 = ev[1], x = v;
+            auto r = (e1 == x) ? e0 : Index::invalidValue;
+            return (e0 == x) ? e1 : r;
+        }
+
+        // return index of v in tri_verts, or invalid if not found
+        inline Index find_tri_index(Index v, const Index3 &tri_verts)
+        {
+            Index::value_type t0 = tri_verts[0], t1 = tri_verts[1], t2 = tri_verts[2], x = v;
+            auto r = (t2 == x) ? 2u : Index::invalidValue;
+            r = (t1 == x) ? 1u : r;
+            return (t0 == x) ? 0u : r;
+        }
+
+        // return index j of the edge [tri_verts[j], tri_verts[j+1]] equal to [a,b] ignoring
+        // order, or invalid if not found
+        inline Index find_edge_index_in_tri(Index a, Index b, const Index3 &tri_verts)
+        {
+            Index t0 = tri_verts[0], t1 = tri_verts[1], t2 = tri_verts[2];
+            auto r = same_pair_unordered(a, b, t2, t0) ? 2u : Index::invalidValue;
+            r = same_pair_unordered(a, b, t1, t2) ? 1u : r;
+            return same_pair_unordered(a, b, t0, t1) ? 0u : r;
+        }
+
+        // test if a is directly followed by b in the winding of tri_verts
+        inline bool tri_has_sequential_v(const Index3 &tri_verts, Index a, Index b)
+        {
+            Index t0 = tri_verts[0], t1 = tri_verts[1], t2 = tri_verts[2];
+            return ((t0 == a) & (t1 == b)) | ((t1 == a) & (t2 == b)) | ((t2 == a) & (t0 == b));
+        }
+
+        // find the vtx of tri_verts that is neither a nor b
+        inline Index find_tri_other_v(Index a, Index b, const Index3 &tri_verts)
+        {
+            Index::value_type t0 = tri_verts[0], t1 = tri_verts[1], t2 = tri_verts[2], x = a, y = b;
+            auto r = ((t2 != x) & (t2 != y)) ? t2 : Index::invalidValue;
+            r = ((t1 != x) & (t1 != y)) ? t1 : r;
+            return ((t0 != x) & (t0 != y)) ? t0 : r;
+        }
+
+        // Bulk operations over arrays of Index2/Index3/Index4. indexType.h asserts that an
+        // element is exactly N packed 32 bit values, so an array is walked as one flat
+        // run of values; the loops are written for the auto-vectorizer.
+
+        template<typename IndexN>
+        inline Index::value_type* flat_values(IndexN *indices)
+        { return reinterpret_cast<Index::value_type*>(indices); }
+
+        template<typename IndexN>
+        inline const Index::value_type* flat_values(const IndexN *indices)
+        { return reinterpret_cast<const Index::value_type*>(indices); }
+
+        // set every element to 'value'
+        template<typename IndexN>
+        inline void fill(IndexN *indices, std::size_t count, const IndexN &value)
+        {
+            constexpr int n = IndexN::num;
+            Index::value_type v[n];
+            for (int j = 0; j < n; ++j) v[j] = value[j];
+
+            auto q = flat_values(indices);
+            for (std::size_t i = 0; i < count; ++i)
+                for (int j = 0; j < n; ++j) q[i * n + j] = v[j];
+        }
+
+        template<typename IndexN, typename Alloc>
+        inline void fill(std::vector<IndexN, Alloc> &indices, const IndexN &value)
+        { fill(indices.data(), indices.size(), value); }
+
+        // Replaces every valid index value i by map[i], invalid values stay invalid. 'map'
+        // is a permutation or compaction table (int, unsigned or Index) that covers all
+        // valid values and may map to invalid to drop a value.
+        template<typename IndexN, typename Map>
+        inline void remap(IndexN *indices, std::size_t count, const Map *map)
+        {
+            using value_type = Index::value_type;
+            constexpr std::size_t bufferSize = 256;
+            auto q = flat_values(indices);
+            auto n = count * IndexN::num;
+            value_type buffer[bufferSize];
+            for (std::size_t begin = 0; begin < n; begin += bufferSize)
+            {
+                auto m = n - begin < bufferSize ? n - begin : bufferSize;
+                // invalid values read map[0] and are or-ed back to invalid; writing into
+                // a local buffer keeps the table lookups free of aliasing with 'q'
+                for (std::size_t i = 0; i < m; ++i)
+                {
+                    auto x = q[begin + i];
+                    auto invalid = value_type(0) - value_type(x == Index::invalidValue);
+                    buffer[i] = static_cast<value_type>(map[x & ~invalid]) | invalid;
+                }
+                for (std::size_t i = 0; i < m; ++i) q[begin + i] = buffer[i];
+            }
+        }
+
+        template<typename IndexN, typename Alloc, typename Map, typename MapAlloc>
+        inline void remap(std::vector<IndexN, Alloc> &indices, const std::vector<Map, MapAlloc> &map)
+        { if (!map.empty()) remap(indices.data(), indices.size(), map.data()); }
+
+        // number of invalid index values, every component counts
+        template<typename IndexN>
+        inline std::size_t count_invalid(const IndexN *indices, std::size_t count)
+        {
+            auto q = flat_values(indices);
+            auto n = count * IndexN::num;
+            std::size_t c = 0;
+            for (std::size_t i = 0; i < n; ++i) c += (q[i] == Index::invalidValue);
+            return c;
+        }
+
+        template<typename IndexN, typename Alloc>
+        inline std::size_t count_invalid(const std::vector<IndexN, Alloc> &indices)
+        { return count_invalid(indices.data(), indices.size()); }
+
+        // true if no component of any element is invalid; scans in blocks to stop early
+        template<typename IndexN>
+        inline bool all_valid(const IndexN *indices, std::size_t count)
+        {
+            constexpr std::size_t blockSize = 4096;
+            auto q = flat_values(indices);
+            auto n = count * IndexN::num;
+            for (std::size_t begin = 0; begin < n; begin += blockSize)
+            {
+                auto end = n - begin < blockSize ? n : begin + blockSize;
+                unsigned invalid = 0;
+                for (auto i = begin; i < end; ++i) invalid |= (q[i] == Index::invalidValue);
+                if (invalid) return false;
+            }
+            return true;
+        }
+
+        template<typename IndexN, typename Alloc>
+        inline bool all_valid(const std::vector<IndexN, Alloc> &indices)
+        { return all_valid(indices.data(), indices.size()); }
     }
 }
 
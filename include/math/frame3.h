@@ -1,12 +1,21 @@
 ﻿#ifndef G3_MATH_FRAME_3
 #define G3_MATH_FRAME_3
 
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+
 #include <math/quaternion.h>
+#include <math/matrix3.h>
+#include <math/pointSet3.h>
 #include <math/Box3.h>
 #include <math/ray3.h>
 
 namespace g3
 {
+    // Rigid frame: origin plus rotation. The rotation matrix, whose columns are the
+    // frame axes, is cached next to the quaternion and refreshed by every function
+    // that changes the rotation; axis queries and point mappings read the cache.
     template<typename T>
     class Frame3
     {
@@ -18,6 +27,7 @@ namespace g3
         using matrix_type = Matrix3<value_type>;
         using box_type = Box3<T>;
         using ray_type = Ray3<T>;
+        using point_set_type = PointSet3<T>;
         using self_type = Frame3<T>;
 
         // static values
@@ -27,7 +37,7 @@ namespace g3
         // Interpolate between two frames - Lerp for origin, Slerp for rotation
         static self_type interpolate(const self_type &f1, const self_type &f2, value_type t)
         {
-            return self_type(vector_type::lerp(f1.origin(), f2.origin()),
+            return self_type(vector_type::lerp(f1.origin(), f2.origin(), t),
                 quat_type::slerp(f1.rotation(), f2.rotation(), t));
         }
 
@@ -54,7 +64,7 @@ namespace g3
                     }
                 }
 
-            self_type R1 = source.rotated(quat_type::fromTo(source.getAxis(best_i), target.getAxis(best_j) * maxSign));
+            self_type R1 = source.rotated(quat_type::formTo(source.getAxis(best_i), target.getAxis(best_j) * maxSign));
             vector_type vAround = R1.getAxis(best_i);
 
             int second_i = -1, second_j = -1;
@@ -82,13 +92,14 @@ namespace g3
         }
 
         // constructors
-        Frame3(const vector_type &o) : _rotation(quat_type::indentity), _origin(o)
-        {}
+        Frame3(const vector_type &o) : _origin(o), _rotation(quat_type::indentity)
+        { updateAxes(); }
 
         Frame3(const vector_type &origin, const vector_type &setZ) :
             _origin(origin)
         {
-            _rotation = quat_type::setFromTo(vector_type::axisZ, setZ);
+            _rotation = quat_type::formTo(vector_type::axisZ, setZ);
+            updateAxes();
         }
 
         Frame3(const vector_type &origin, const vector_type &setAxis, int nAxis) :
@@ -98,34 +109,40 @@ namespace g3
             if (nAxis == 0) originAxis = vector_type::axisX;
             else if (nAxis == 1) originAxis = vector_type::axisY;
             else originAxis = vector_type::axisZ;
-            _rotation = quat_type::setFromTo(originAxis, setAxis);
+            _rotation = quat_type::formTo(originAxis, setAxis);
+            updateAxes();
         }
 
         Frame3(const vector_type &origin, const quat_type &rotation) :
             _origin(origin), _rotation(rotation)
-        {}
+        { updateAxes(); }
 
         Frame3(const vector_type &origin,
                const vector_type &x, const vector_type &y, const vector_type &z) : 
-            _origin(oringin)
+            _origin(origin)
         {
             matrix_type mat(x, y, z, true);
             _rotation = quat_type(mat);
+            updateAxes();
         }
 
         // type conversion
         template<typename U>
         operator Frame3<U>() const
         {
-            return Frame3<U>(static_cast<typename Frame3::vector_type>(_origin),
+            return Frame3<U>(static_cast<typename Frame3<U>::vector_type>(_origin),
                              static_cast<typename Frame3<U>::quat_type>(_rotation));
         }
 
         // functions
         const quat_type& rotation() const
         { return _rotation; }
-        quat_type& rotation()
-        { return _rotation; }
+        void setRotation(const quat_type &q)
+        { _rotation = q; updateAxes(); }
+
+        // cached rotation matrix, columns are the axes x(), y() and z()
+        const matrix_type& rotationMatrix() const
+        { return _axes; }
 
         const vector_type& origin() const
         { return _origin; }
@@ -133,20 +150,16 @@ namespace g3
         { return _origin; }
 
         vector_type x() const
-        { return _rotation.axisX(); }
+        { return _axes.column(0); }
 
         vector_type y() const
-        { return _rotation.axisY(); }
+        { return _axes.column(1); }
 
         vector_type z() const
-        { return _rotation.axisZ(); }
+        { return _axes.column(2); }
 
         vector_type getAxis(int nAxis) const
-        {
-            if (nAxis == 0) return _rotation * vector_type::axisX;
-            else if (nAxis == 1) return _rotation * vector_type::axisY;
-            else return _rotation * vector_type::axisZ;
-        }
+        { return _axes.column(nAxis); }
 
         void translate(const vector_type &v)
         { _origin = _origin + v; }
@@ -170,25 +183,26 @@ namespace g3
         { return self_type(_origin * sv, _rotation); }
 
         void rotate(const quat_type &q)
-        { _rotation = q * _rotation; }
+        { _rotation = q * _rotation; updateAxes(); }
 
         self_type rotated(const quat_type &q) const
         { return self_type(_origin, q * _rotation); }
 
         self_type rotated(value_type angel, int nAxis, bool isDeg = true) const
-        { return rotated(quat_type(getAxis(nAxis), nAxis, isDeg)); }
+        { return rotated(quat_type(getAxis(nAxis), angel, isDeg)); }
 
         // this rotates the frame around its own axes, rather than around the world axes,
         // which is what Rotate() does. So, RotateAroundAxis(AxisAngleD(Z,180)) is equivalent
         // to Rotate(AxisAngleD(My_AxisZ,180)). 
         void rotateAroundAxes(const quat_type &q)
-        { _rotation = _rotation * q; }
+        { _rotation = _rotation * q; updateAxes(); }
 
         void rotateAround(const vector_type &point, const quat_type &q)
         {
             auto dv = q * (_origin - point);
             _rotation = q * _rotation;
             _origin = point + dv;
+            updateAxes();
         }
 
         self_type rotatedAround(const vector_type &point, const quat_type &q) const
@@ -199,7 +213,7 @@ namespace g3
 
         void alignAxis(int nAxis, const vector_type &vTo)
         {
-            auto rot = quat_type::setFromTo(getAxis(nAxis), vTo);
+            auto rot = quat_type::formTo(getAxis(nAxis), vTo);
             rotate(rot);
         }
 
@@ -212,7 +226,7 @@ namespace g3
         }
 
         //3D projection of point p onto frame-axis plane orthogonal to normal axis
-        vector_type projectToPlane(const vector_type &p, inr nNormal) const
+        vector_type projectToPlane(const vector_type &p, int nNormal) const
         {
             auto d = p - _origin;
             auto n = getAxis(nNormal);
@@ -223,11 +237,11 @@ namespace g3
         // [TODO] check that mapping preserves orientation?
         vector_type fromPlaneUV(const vector2_type &v, int nPlaneNormalAxis) const
         {
-            vector_type dv
+            vector_type dv;
             if (nPlaneNormalAxis == 0) dv.set(0, v[1], v[0]);
             else if (nPlaneNormalAxis == 1) dv.set(v[0], 0, v[1]);
             else dv.set(v[0], v[1], 0);
-            return _rotation * dv + _origin;
+            return _axes * dv + _origin;
         }
 
         // Project p onto plane axes
@@ -235,15 +249,31 @@ namespace g3
         vector2_type toPlaneUV(const vector_type &p, int nNormal) const
         {
             int nAxis[2];
-            if (nNormal == 0) { nAxis[0] = 2; nAxis[1] = 1; }
-            else if (nNormal == 1) { nAxis[0] = 0; nAxis[1] = 2; }
-            else { nAxis[0] = 0; nAxis[1] = 1; }
+            planeAxes(nNormal, nAxis);
             auto d = p - _origin;
             auto fu = d.dot(getAxis(nAxis[0]));
             auto fv = d.dot(getAxis(nAxis[1]));
             return vector2_type(fu, fv);
         }
 
+        // batch form of toPlaneUV(), 'out' must hold 'count' values
+        void toPlaneUV(const vector_type *in, vector2_type *out, std::size_t count, int nNormal) const
+        {
+            int nAxis[2];
+            planeAxes(nNormal, nAxis);
+            auto u = getAxis(nAxis[0]), v = getAxis(nAxis[1]);
+            auto ux = u.x(), uy = u.y(), uz = u.z(), vx = v.x(), vy = v.y(), vz = v.z();
+            auto ox = _origin.x(), oy = _origin.y(), oz = _origin.z();
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                auto dx = in[i].x() - ox, dy = in[i].y() - oy, dz = in[i].z() - oz;
+                out[i] = vector2_type(dx * ux + dy * uy + dz * uz, dx * vx + dy * vy + dz * vz);
+            }
+        }
+
+        void toPlaneUV(const std::vector<vector_type> &in, std::vector<vector2_type> &out, int nNormal) const
+        { out.resize(in.size()); toPlaneUV(in.data(), out.data(), in.size(), nNormal); }
+
         value_type distanceToPlaneSigned(const vector_type &p, int nNormal) const
         { return (p - _origin).dot(getAxis(nNormal)); }
 
@@ -252,22 +282,59 @@ namespace g3
 
         // Map point *into* local coordinates of Frame
         vector_type toFrameP(const vector_type &p) const
-        {
-            auto tem = p - _origin;
-            return _rotation.inverseMultiply(tem);
-        }
+        { return (p - _origin) * _axes; }
 
         // Map point *from* local frame coordinates into "world" coordinates
         vector_type fromFrameP(const vector_type &p) const
-        { return _rotation * p + _origin; }
+        { return _axes * p + _origin; }
 
         // Map vector *into* local coordinates of Frame
         vector_type toFrameV(const vector_type &v) const
-        { eturn _rotation.inverseMultiply(v); }
+        { return v * _axes; }
 
         // Map vector *from* local frame coordinates into "world" coordinates
         vector_type fromFrameV(const vector_type &v) const
-        { return _rotation * v; }
+        { return _axes * v; }
+
+        // Batch forms of the four mappings above over 'count' points or vectors, 'in' and
+        // 'out' may be the same buffer. They stream the points through the cached rotation
+        // matrix; toFrameP subtracts the origin before rotating, so points far from the
+        // world origin keep their precision relative to the frame.
+        void toFrameP(const vector_type *in, vector_type *out, std::size_t count) const
+        { _axes.transpose().transform(in, out, count, vector_type::zero, _origin); }
+
+        void fromFrameP(const vector_type *in, vector_type *out, std::size_t count) const
+        { _axes.transform(in, out, count, _origin); }
+
+        void toFrameV(const vector_type *in, vector_type *out, std::size_t count) const
+        { _axes.transpose().transform(in, out, count); }
+
+        void fromFrameV(const vector_type *in, vector_type *out, std::size_t count) const
+        { _axes.transform(in, out, count); }
+
+        void toFrameP(const std::vector<vector_type> &in, std::vector<vector_type> &out) const
+        { out.resize(in.size()); toFrameP(in.data(), out.data(), in.size()); }
+
+        void fromFrameP(const std::vector<vector_type> &in, std::vector<vector_type> &out) const
+        { out.resize(in.size()); fromFrameP(in.data(), out.data(), in.size()); }
+
+        void toFrameV(const std::vector<vector_type> &in, std::vector<vector_type> &out) const
+        { out.resize(in.size()); toFrameV(in.data(), out.data(), in.size()); }
+
+        void fromFrameV(const std::vector<vector_type> &in, std::vector<vector_type> &out) const
+        { out.resize(in.size()); fromFrameV(in.data(), out.data(), in.size()); }
+
+        void toFrameP(const point_set_type &in, point_set_type &out) const
+        { _axes.transpose().transform(in, out, vector_type::zero, _origin); }
+
+        void fromFrameP(const point_set_type &in, point_set_type &out) const
+        { _axes.transform(in, out, _origin); }
+
+        void toFrameV(const point_set_type &in, point_set_type &out) const
+        { _axes.transpose().transform(in, out); }
+
+        void fromFrameV(const point_set_type &in, point_set_type &out) const
+        { _axes.transform(in, out); }
 
         // Map quaternion *into* local coordinates of Frame
         quat_type toFrame(const quat_type &q) const
@@ -346,8 +413,20 @@ namespace g3
 
 
     private:
+        void updateAxes()
+        { _axes = _rotation.toRotationMatrix(); }
+
+        // in-plane axes of the plane normal to axis 'nNormal'
+        static void planeAxes(int nNormal, int nAxis[2])
+        {
+            if (nNormal == 0) { nAxis[0] = 2; nAxis[1] = 1; }
+            else if (nNormal == 1) { nAxis[0] = 0; nAxis[1] = 2; }
+            else { nAxis[0] = 0; nAxis[1] = 1; }
+        }
+
         vector_type _origin;
         quat_type _rotation;
+        matrix_type _axes;
     };
 
     using Frame3d = Frame3<double>;
@@ -5,6 +5,9 @@
 
 namespace g3
 {
+    // Element index, 4 bytes, invalid is all bits set. Index and the IndexTemplate
+    // family are trivially copyable standard layout types, so arrays of them can be
+    // copied with memcpy and their loops vectorize like loops over unsigned.
     class Index
     {
     public:
@@ -12,34 +15,33 @@ namespace g3
         using self_type = Index;
 
         // static values
-        static const value_type invalidValue;
+        static constexpr value_type invalidValue = 0xffffffff;
 
         // constructions
-        Index() { _index = invalidValue; };
-        Index(int i) { if (i < 0) _index = invalidValue; else _index = i; }
-        Index(value_type i) { _index = i; }
+        constexpr Index() : _index(invalidValue) {}
+        constexpr Index(int i) : _index(i < 0 ? invalidValue : static_cast<value_type>(i)) {}
+        constexpr Index(value_type i) : _index(i) {}
 
         // functions
-        bool valid() { return _index != invalidValue; }
+        constexpr bool valid() const { return _index != invalidValue; }
         void invalidate() { _index = invalidValue; }
 
         // operator functions
-        operator value_type() { return _index; }
+        constexpr operator value_type() const { return _index; }
 
-        bool operator == (const self_type &i) const { return _index == i._index; }
-        bool operator != (const self_type &i) const { return !((*this) == i); }
+        constexpr bool operator == (const self_type &i) const { return _index == i._index; }
+        constexpr bool operator != (const self_type &i) const { return !((*this) == i); }
 
     private:
         value_type _index;
     };
 
-    const Index::value_type Index::invalidValue = 0xffffffff;
-
     template<int N, class = typename std::enable_if<(N > 0)>::type>
     class IndexTemplate
     {
     public:
         using index_type = Index;
+        using value_type = Index::value_type;
         using self_type  = IndexTemplate<N>;
 
         // static values
@@ -49,38 +51,36 @@ namespace g3
         static const int num = N;
 
         // constructors
-        IndexTemplate() { for (int j = 0; j < N; ++j) _indices[j] = index_type::invalidValue; }
-        IndexTemplate(index_type i) { for (int j = 0; j < N; ++j) _indices[j] = i; }
-        IndexTemplate(const self_type &i) { for (int j = 0; j < N; ++j) _indices[j] = i._indices[j]; }
+        constexpr IndexTemplate() {}
+        constexpr IndexTemplate(index_type i) { for (int j = 0; j < N; ++j) _indices[j] = i; }
 
         // functions
-        bool valid()
+        constexpr bool valid() const
         {
-            for (int j = 0; j < N; ++j) if (!_indices[j].valid()) return false;
-            return true;
+            bool v = true;
+            for (int j = 0; j < N; ++j) v &= _indices[j].valid();
+            return v;
         }
 
         void invalidate()
         { for (int j = 0; j < N; ++j) _indices[j].invalidate(); }
 
-        // TODO : realize funtion array()
+        index_type* data() { return _indices; }
+        const index_type* data() const { return _indices; }
 
         // operator functions
-        index_type  operator [] (int i) const
-        { return (i >= 0 && i < num) ? _indices[i] : (i < 0) ? _indices[0] : _indices[num - 1]; }
-        index_type& operator [] (int i)
-        { return (i >= 0 && i < num) ? _indices[i] : (i < 0) ? _indices[0] : _indices[num - 1]; }
-
-        self_type& operator = (const self_type &other)
-        { for (int j = 0; j < N; ++j) _indices[j] = other._indices[j]; return *this; }
+        // 'i' must be in [0, N)
+        constexpr index_type  operator [] (int i) const { return _indices[i]; }
+        constexpr index_type& operator [] (int i) { return _indices[i]; }
 
-        bool operator == (const self_type &other) const
+        constexpr bool operator == (const self_type &other) const
         {
-            for (int j = 0; j < N; ++j) if (!(_indices[j] == other[j])) return false;
-            return true;
+            bool e = true;
+            for (int j = 0; j < N; ++j) e &= (_indices[j] == other._indices[j]);
+            return e;
         }
 
-        bool operator != (const self_type &other) const
+        constexpr bool operator != (const self_type &other) const
         { return !((*this) == other); }
 
     protected:
@@ -88,22 +88,22 @@ namespace g3
     };
 
     template<int N, class U>
-    const IndexTemplate<N> IndexTemplate<N, U>::zero = IndexTemplate<N>(0);
+    inline constexpr IndexTemplate<N> IndexTemplate<N, U>::zero = IndexTemplate<N>(0);
 
     template<int N, class U>
-    const IndexTemplate<N> IndexTemplate<N, U>::one = IndexTemplate<N>(1);
+    inline constexpr IndexTemplate<N> IndexTemplate<N, U>::one = IndexTemplate<N>(1);
 
     template<int N, class U>
-    const IndexTemplate<N> IndexTemplate<N, U>::invalid = IndexTemplate<N>(Index::invalidValue);
+    inline constexpr IndexTemplate<N> IndexTemplate<N, U>::invalid = IndexTemplate<N>(Index::invalidValue);
 
     class Index2 : public IndexTemplate<2>
     {
     public:
         using base_type = IndexTemplate<2>;
 
-        Index2() : base_type() {}
-        Index2(index_type i) : base_type(i) {}
-        Index2(index_type i0, index_type i1)
+        constexpr Index2() : base_type() {}
+        constexpr Index2(index_type i) : base_type(i) {}
+        constexpr Index2(index_type i0, index_type i1)
         { _indices[0] = i0; _indices[1] = i1; }
     };
 
@@ -112,11 +112,11 @@ namespace g3
     public:
         using base_type = IndexTemplate<3>;
 
-        Index3() : base_type() {}
-        Index3(index_type i) : base_type(i) {}
-        Index3(index_type i0, index_type i1, index_type i2)
+        constexpr Index3() : base_type() {}
+        constexpr Index3(index_type i) : base_type(i) {}
+        constexpr Index3(index_type i0, index_type i1, index_type i2)
         { _indices[0] = i0; _indices[1] = i1; _indices[2] = i2; }
-        Index3(index_type i0, index_type i1, index_type i2, bool cycle)
+        constexpr Index3(index_type i0, index_type i1, index_type i2, bool cycle)
         {
             _indices[0] = i0;
             if (cycle) { _indices[1] = i2; _indices[2] = i1; }
@@ -129,11 +129,20 @@ namespace g3
     public:
         using base_type = IndexTemplate<4>;
 
-        Index4() : base_type() {}
-        Index4(index_type i) : base_type(i) {}
-        Index4(index_type i0, index_type i1, index_type i2, index_type i3)
+        constexpr Index4() : base_type() {}
+        constexpr Index4(index_type i) : base_type(i) {}
+        constexpr Index4(index_type i0, index_type i1, index_type i2, index_type i3)
         { _indices[0] = i0; _indices[1] = i1; _indices[2] = i2; _indices[3] = i3; }
     };
+
+    static_assert(sizeof(Index) == 4 && alignof(Index) == 4, "Index must be a bare 32 bit value");
+    static_assert(sizeof(Index2) == 8 && alignof(Index2) == 4, "Index2 must be tightly packed");
+    static_assert(sizeof(Index3) == 12 && alignof(Index3) == 4, "Index3 must be tightly packed");
+    static_assert(sizeof(Index4) == 16 && alignof(Index4) == 4, "Index4 must be tightly packed");
+    static_assert(std::is_trivially_copyable<Index>::value && std::is_trivially_copyable<Index2>::value &&
+                  std::is_trivially_copyable<Index3>::value && std::is_trivially_copyable<Index4>::value,
+                  "index types must be trivially copyable");
+    static_assert(std::is_standard_layout<Index3>::value, "Index3 must be standard layout");
 }
 
 #endif
@@ -10,14 +10,14 @@ namespace g3
     class Line2
     {
     public:
-        using vector_type = Vector2Traits<T>::vector_type;
+        using vector_type = typename Vector2Traits<T>::vector_type;
         using value_type = typename vector_type::value_type;
         using self_type = Line2<T>;
 
         // static values
 
         // static functions
-        self_type fromPoints(const vector_type &p0, const vector_type &p1)
+        static self_type fromPoints(const vector_type &p0, const vector_type &p1)
         { return self_type(p0, (p1 - p0).normalized()); }
 
         // constructors
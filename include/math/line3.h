@@ -9,7 +9,7 @@ namespace g3
     class Line3
     {
     public:
-        using vector_type = Vector3Traits<T>::vector_type;
+        using vector_type = typename Vector3Traits<T>::vector_type;
         using value_type = typename vector_type::value_type;
         using self_type = Line3<T>;
 
@@ -18,7 +18,7 @@ namespace g3
         // static functions
 
         // constructors
-        Line3(const vector_type &o, const vector_type *d) : _origin(o), _direction(d) {}
+        Line3(const vector_type &o, const vector_type &d) : _origin(o), _direction(d) {}
 
         // type conversion
         template <typename U>
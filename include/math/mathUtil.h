@@ -5,19 +5,19 @@ namespace g3
 {
     namespace mathUtil
     {
-        constexpr double PI      = 3.1415926535897932384626433832795;
-        constexpr double twoPI   = 2.0 * PI;
-        constexpr double halfPI  = 0.5 * PI;
+        inline constexpr double PI      = 3.1415926535897932384626433832795;
+        inline constexpr double twoPI   = 2.0 * PI;
+        inline constexpr double halfPI  = 0.5 * PI;
 
-        constexpr double deg2rad = PI / 180.0;
-        constexpr double rad2deg = 180 / PI;
+        inline constexpr double deg2rad = PI / 180.0;
+        inline constexpr double rad2deg = 180 / PI;
 
-        constexpr double zeroTolerance = 1e-08;
-        constexpr double epsilon       = 2.2204460492503131e-016;
+        inline constexpr double zeroTolerance = 1e-08;
+        inline constexpr double epsilon       = 2.2204460492503131e-016;
 
-        constexpr double sqrtTwo    = 1.4142135623730950488016887242097;
-        constexpr double sqrtTwoInv = 1.0 / sqrtTwo;
-        constexpr double sqrtThree  = 1.7320508075688772935274463415059;
+        inline constexpr double sqrtTwo    = 1.4142135623730950488016887242097;
+        inline constexpr double sqrtTwoInv = 1.0 / sqrtTwo;
+        inline constexpr double sqrtThree  = 1.7320508075688772935274463415059;
 
         template<typename T>
         constexpr T getPI() { return static_cast<T>(PI); }
@@ -24,37 +24,24 @@ namespace g3
         // static functions
 
         // constructors
-        Matrix2(bool isIdentity = false)
-        {
-            if (isIdentity)
-            {
-                _row0 = vector_type::axisX;
-                _row1 = vector_type::axisY;
-            }
-            else
-            { _row0 = _row1 = vector_type::zero; }
-        }
-        Matrix2(value_type m00, value_type m01, value_type m10, value_type m11)
-        { _row0[0] = m00; _row0[1] = m01; _row1[0] = m10; _row1[1] = m11; }
-        Matrix2(value_type m00, value_type m11)
-        { _row0[0] = m00; _row1[1] = m11; _row0[1] = _row1[0] = 0; }
+        constexpr Matrix2(bool isIdentity = false)
+            : _row0(isIdentity ? vector_type::axisX : vector_type::zero),
+              _row1(isIdentity ? vector_type::axisY : vector_type::zero) {}
+        constexpr Matrix2(value_type m00, value_type m01, value_type m10, value_type m11)
+            : _row0(m00, m01), _row1(m10, m11) {}
+        constexpr Matrix2(value_type m00, value_type m11)
+            : _row0(m00, 0), _row1(0, m11) {}
         Matrix2(value_type angle, bool isDegree)
         {
             if (isDegree) setToRotationDeg(angle);
             else setToRotationRad(angle);
         }
-        Matrix2(const vector_type &u, const vector_type &v, bool beColumns)
-        {
-            if (beColumns) { _row0[0] = u[0]; _row0[1] = v[0]; _row1[0] = u[1]; _row1[1] = v[1]; }
-            else { _row0 = u; _row1 = v; }
-        }
-        Matrix2(const vector_type &u, const vector_type &v) // tensor product of u,v --> u * v^T
-        {
-            _row0[0] = u.x() * v.x();
-            _row0[1] = u.x() * v.y();
-            _row1[0] = u.y() * v.x();
-            _row1[1] = u.y() * v.y();
-        }
+        constexpr Matrix2(const vector_type &u, const vector_type &v, bool beColumns)
+            : _row0(beColumns ? vector_type(u[0], v[0]) : u),
+              _row1(beColumns ? vector_type(u[1], v[1]) : v) {}
+        constexpr Matrix2(const vector_type &u, const vector_type &v) // tensor product of u,v --> u * v^T
+            : _row0(u.x() * v.x(), u.x() * v.y()),
+              _row1(u.y() * v.x(), u.y() * v.y()) {}
 
         // type conversion
         template<typename U>
@@ -65,19 +52,19 @@ namespace g3
         }
 
         // functions
-        void setToRow(const vector_type &u, const vector_type &v)
+        constexpr void setToRow(const vector_type &u, const vector_type &v)
         { _row0 = u; _row1 = v; }
 
-        void setToRow(value_type m00, value_type m01, value_type m10, value_type m11)
+        constexpr void setToRow(value_type m00, value_type m01, value_type m10, value_type m11)
         { _row0[0] = m00; _row0[1] = m01; _row1[0] = m10; _row1[1] = m11; }
 
-        void setToColumn(const vector_type &u, const vector_type &v)
+        constexpr void setToColumn(const vector_type &u, const vector_type &v)
         { _row0[0] = u[0]; _row0[1] = v[0]; _row1[0] = u[1]; _row1[1] = v[1]; }
 
-        void setToColumn(value_type m00, value_type m10, value_type m01, value_type m11)
+        constexpr void setToColumn(value_type m00, value_type m10, value_type m01, value_type m11)
         { _row0[0] = m00; _row0[1] = m01; _row1[0] = m10; _row1[1] = m11; }
 
-        void setToDiagonal(value_type m00, value_type m11)
+        constexpr void setToDiagonal(value_type m00, value_type m11)
         { _row0[0] = m00; _row1[1] = m11; _row0[1] = _row1[0] = 0; }
 
         void setToRotationRad(value_type angle)
@@ -88,18 +75,18 @@ namespace g3
         }
 
         void setToRotationDeg(value_type anlge)
-        { setToRotationRad(anlge * mathUtil::getRad2Deg<value_type>()); }
+        { setToRotationRad(anlge * mathUtil::getDeg2Rad<value_type>()); }
 
-        value_type qForm(const vector_type &u, const vector_type &v) const
+        constexpr value_type qForm(const vector_type &u, const vector_type &v) const
         { return u.dot((*this) * v); }
 
-        self_type transpose() const
+        constexpr self_type transpose() const
         { return self_type(_row0, _row1, true); }
 
-        self_type inverse(value_type epsilon = mathUtil::getEpsilon<value_type>()) const
+        constexpr self_type inverse(value_type epsilon = mathUtil::getEpsilon<value_type>()) const
         {
             auto det = determinant();
-            if (std::abs(det) > epsilon)
+            if (det > epsilon || -det > epsilon)
             {
                 auto invDet = 1 / det;
                 return (adjoint() * invDet);
@@ -108,20 +95,20 @@ namespace g3
                 return zero;
         }
 
-        self_type adjoint() const
+        constexpr self_type adjoint() const
         { return self_type(_row1[1], -_row0[1], -_row1[0], _row0[0]); }
 
-        value_type determinant() const
+        constexpr value_type determinant() const
         { return _row0[0] * _row1[1] - _row0[1] * _row1[0]; }
 
         // precondition: this matrix represents a rotation
         value_type extractAngle() const
         { return std::atan2(_row1[0], _row0[0]); }
 
-        vector_type row(int i) const
+        constexpr vector_type row(int i) const
         { return (i == 0) ? _row0 : _row1; }
 
-        vector_type column(int i) const
+        constexpr vector_type column(int i) const
         { return (i == 0) ? vector_type(_row0[0], _row1[0]) : vector_type(_row0[1], _row1[1]); }
 
         // Algorithm uses Gram-Schmidt orthogonalization.  If 'this' matrix is
@@ -178,56 +165,61 @@ namespace g3
         }
 
         // operator functions
-        vector_type& operator [] (int r)
+        constexpr vector_type& operator [] (int r)
         { return (r == 0) ? _row0 : _row1; }
-        vector_type  operator [] (int r) const
+        constexpr vector_type  operator [] (int r) const
         { return (r == 0) ? _row0 : _row1; }
 
-        self_type operator - () const
+        constexpr self_type operator - () const
         { return self_type(-_row0, -_row1, false); }
-        self_type operator - (const self_type &m) const
+        constexpr self_type operator - (const self_type &m) const
         { return self_type(_row0 - m._row0, _row1 - m._row1, false); }
-        self_type operator - (value_type n) const
+        constexpr self_type operator - (value_type n) const
         { return self_type(_row0 - n, _row1 - n, false); }
 
-        self_type operator + (const self_type &m) const
+        constexpr self_type operator + (const self_type &m) const
         { return self_type(_row0 + m._row0, _row1 + m._row1, false); }
-        self_type operator + (value_type n) const
+        constexpr self_type operator + (value_type n) const
         { return self_type(_row0 + n, _row1 + n, false); }
 
-        self_type operator * (value_type n) const
+        constexpr self_type operator * (const self_type &m) const
+        {
+            auto mCol0 = m.column(0), mCol1 = m.column(1);
+            return self_type(_row0.dot(mCol0), _row0.dot(mCol1), _row1.dot(mCol0), _row1.dot(mCol1));
+        }
+        constexpr self_type operator * (value_type n) const
         { return self_type(_row0 * n, _row1 * n, false); }
-        template<typename T>
-        friend Matrix2<T> operator * (typename Matrix2<T>::value_type n, const Matrix2<T> &m);
+        template<typename U>
+        friend constexpr Matrix2<U> operator * (typename Matrix2<U>::value_type n, const Matrix2<U> &m);
 
-        self_type operator / (value_type n) const
+        constexpr self_type operator / (value_type n) const
         { return self_type(_row0 / n, _row1 / n, false); }
 
-        vector_type operator * (const vector_type &v) const
+        constexpr vector_type operator * (const vector_type &v) const
         { return vector_type(_row0.dot(v), _row1.dot(v)); }
-        template<typename T>
-        friend typename Matrix2<T>::vector_type operator * (const typename Matrix2<T>::vector_type &v, const Matrix2<T> &m);
+        template<typename U>
+        friend constexpr typename Matrix2<U>::vector_type operator * (const typename Matrix2<U>::vector_type &v, const Matrix2<U> &m);
 
     private:
         vector_type _row0, _row1;
     };
 
     template<typename T>
-    const Matrix2<T> Matrix2<T>::identity = Matrix2<T>(true);
+    inline constexpr Matrix2<T> Matrix2<T>::identity = Matrix2<T>(true);
 
     template<typename T>
-    const Matrix2<T> Matrix2<T>::zero = Matrix2<T>();
+    inline constexpr Matrix2<T> Matrix2<T>::zero = Matrix2<T>();
 
     template<typename T>
-    const Matrix2<T> Matrix2<T>::one = Matrix2<T>(1, 1, 1, 1);
+    inline constexpr Matrix2<T> Matrix2<T>::one = Matrix2<T>(1, 1, 1, 1);
 
     template<typename T>
-    Matrix2<T> operator * (typename Matrix2<T>::value_type n, const Matrix2<T> &m)
+    constexpr Matrix2<T> operator * (typename Matrix2<T>::value_type n, const Matrix2<T> &m)
     { return Matrix2<T>(m._row0 * n, m._row1 * n, false); }
 
     template<typename T>
-    typename Matrix2<T>::vector_type operator * (const typename Matrix2<T>::vector_type &v, const Matrix2<T> &m)
-    { return Matrix2<T>::vector_type(v.dot(m.column(0)), v.dot(m.column(1))); }
+    constexpr typename Matrix2<T>::vector_type operator * (const typename Matrix2<T>::vector_type &v, const Matrix2<T> &m)
+    { return typename Matrix2<T>::vector_type(v.dot(m.column(0)), v.dot(m.column(1))); }
 
     using Matrix2d = Matrix2<double>;
     using Matrix2f = Matrix2<float>;
@@ -2,10 +2,13 @@
 #define G3_MATH_MATRIX_3
 
 #include <cmath>
+#include <cstddef>
+#include <algorithm>
 #include <vector>
 #include <functional>
 
 #include <math/mathUtil.h>
+#include <math/pointSet3.h>
 #include <math/vectorTraits.h>
 
 namespace g3
@@ -23,15 +26,30 @@ namespace g3
         static const self_type zero;
 
         // static functions
+        // out[i] = a[i] * b[i] for 'count' matrices, 'out' may be 'a' or 'b'
+        static void multiply(const self_type *a, const self_type *b, self_type *out, std::size_t count)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                auto a0 = a[i]._row0, a1 = a[i]._row1, a2 = a[i]._row2;
+                auto b0 = b[i]._row0, b1 = b[i]._row1, b2 = b[i]._row2;
+                out[i]._row0 = b0 * a0[0] + b1 * a0[1] + b2 * a0[2];
+                out[i]._row1 = b0 * a1[0] + b1 * a1[1] + b2 * a1[2];
+                out[i]._row2 = b0 * a2[0] + b1 * a2[1] + b2 * a2[2];
+            }
+        }
 
-        // constructors
-        Matrix3(bool isIdentity = false)
+        static void multiply(const std::vector<self_type> &a, const std::vector<self_type> &b, std::vector<self_type> &out)
         {
-            if (isIdentity)
-            { _row0 = vector_type::axisX; _row1 = vector_type::axisY; _row2 = vector_type::axisZ; }
-            else
-            { _row0 = _row1 = _row2 = vector_type::zero; }
+            out.resize(a.size());
+            multiply(a.data(), b.data(), out.data(), a.size());
         }
+
+        // constructors
+        constexpr Matrix3(bool isIdentity = false)
+            : _row0(isIdentity ? vector_type::axisX : vector_type::zero),
+              _row1(isIdentity ? vector_type::axisY : vector_type::zero),
+              _row2(isIdentity ? vector_type::axisZ : vector_type::zero) {}
         Matrix3(const std::vector<value_type> m)  // assume input is row-major and no check of out-of-range exception
         {
             _row0.set(m[0], m[1], m[2]);
@@ -56,27 +74,17 @@ namespace g3
             _row1.set(f(1, 0), f(1, 1), f(1, 2));
             _row2.set(f(2, 0), f(2, 1), f(2, 2));
         }
-        Matrix3(value_type m00, value_type m11, value_type m22)
-        { _row0.set(m00, 0, 0); _row1.set(0, m11, 0); _row2.set(0, 0, m22); }
-        Matrix3(const vector_type &v0, const vector_type &v1, const vector_type &v2,
-                bool beColumns)
-        {
-            if (beColumns)
-            {
-                _row0.set(v0[0], v1[0], v2[0]);
-                _row1.set(v0[1], v1[1], v2[1]);
-                _row2.set(v0[2], v1[2], v2[2]);
-            }
-            else { _row0 = v0; _row1 = v1; _row2 = v2; }
-        }
-        Matrix3(value_type m00, value_type m01, value_type m02,
-                value_type m10, value_type m11, value_type m12,
-                value_type m20, value_type m21, value_type m22)
-        {
-            _row0.set(m00, m01, m02);
-            _row1.set(m10, m11, m12);
-            _row2.set(m20, m21, m22);
-        }
+        constexpr Matrix3(value_type m00, value_type m11, value_type m22)
+            : _row0(m00, 0, 0), _row1(0, m11, 0), _row2(0, 0, m22) {}
+        constexpr Matrix3(const vector_type &v0, const vector_type &v1, const vector_type &v2,
+                          bool beColumns)
+            : _row0(beColumns ? vector_type(v0[0], v1[0], v2[0]) : v0),
+              _row1(beColumns ? vector_type(v0[1], v1[1], v2[1]) : v1),
+              _row2(beColumns ? vector_type(v0[2], v1[2], v2[2]) : v2) {}
+        constexpr Matrix3(value_type m00, value_type m01, value_type m02,
+                          value_type m10, value_type m11, value_type m12,
+                          value_type m20, value_type m21, value_type m22)
+            : _row0(m00, m01, m02), _row1(m10, m11, m12), _row2(m20, m21, m22) {}
 
         // type conversion
         template<typename U>
@@ -88,24 +96,24 @@ namespace g3
         }
 
         // functions
-        vector_type row(int i) const
+        constexpr vector_type row(int i) const
         { return (i == 0) ? _row0 : (i == 1) ? _row1 : _row2; }
 
-        vector_type column(int i) const
+        constexpr vector_type column(int i) const
         {
             return (i == 0) ? vector_type(_row0[0], _row1[0], _row2[0]) : 
                    (i == 1) ? vector_type(_row0[1], _row1[1], _row2[1]) : 
                               vector_type(_row0[2], _row1[2], _row2[2]);
         }
 
-        void toBuffer(value_type buffer[]) const // no check of out-of-range exception
+        constexpr void toBuffer(value_type buffer[]) const // no check of out-of-range exception
         {
             buffer[0] = _row0[0]; buffer[1] = _row0[1]; buffer[2] = _row0[2];
             buffer[3] = _row1[0]; buffer[4] = _row1[1]; buffer[5] = _row1[2];
             buffer[6] = _row2[0]; buffer[7] = _row2[1]; buffer[8] = _row2[2];
         }
 
-        value_type determinant() const
+        constexpr value_type determinant() const
         {
             auto x0 = _row2[2] * _row1[1] - _row2[1] * _row1[2];
             auto x1 = -(_row2[2] * _row0[1] - _row2[1] * _row0[2]);
@@ -113,10 +121,10 @@ namespace g3
             return (_row0[0] * x0 + _row1[0] * x1 + _row2[0] * x2);
         }
 
-        self_type inverse(value_type epsilon = mathUtil::getEpsilon<value_type>()) const
+        constexpr self_type inverse(value_type epsilon = mathUtil::getEpsilon<value_type>()) const
         {
             auto det = determinant();
-            if (std::abs(det) > epsilon)
+            if (det > epsilon || -det > epsilon)
             {
                 auto invDet = 1 / det;
 
@@ -138,9 +146,82 @@ namespace g3
                 return zero;
         }
 
-        self_type transpose() const
+        constexpr self_type transpose() const
         { return self_type(_row0, _row1, _row2, true); }
 
+        // Batch transform of 'count' points, out[i] = M * (in[i] - origin) + translation;
+        // 'in' and 'out' may be the same buffer. Each coordinate is one multiply-add chain
+        // starting at the translation, which the compiler contracts to FMA where the target
+        // has it. 'origin' is subtracted before the product, so mapping points near a far
+        // away origin keeps their precision.
+        void transform(const vector_type *in, vector_type *out, std::size_t count,
+                       const vector_type &translation = vector_type::zero,
+                       const vector_type &origin = vector_type::zero) const
+        {
+            auto m00 = _row0[0], m01 = _row0[1], m02 = _row0[2];
+            auto m10 = _row1[0], m11 = _row1[1], m12 = _row1[2];
+            auto m20 = _row2[0], m21 = _row2[1], m22 = _row2[2];
+            auto tx = translation[0], ty = translation[1], tz = translation[2];
+            auto ox = origin[0], oy = origin[1], oz = origin[2];
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                auto x = in[i][0] - ox, y = in[i][1] - oy, z = in[i][2] - oz;
+                out[i] = vector_type(tx + m00 * x + m01 * y + m02 * z,
+                                     ty + m10 * x + m11 * y + m12 * z,
+                                     tz + m20 * x + m21 * y + m22 * z);
+            }
+        }
+
+        void transform(const std::vector<vector_type> &in, std::vector<vector_type> &out,
+                       const vector_type &translation = vector_type::zero,
+                       const vector_type &origin = vector_type::zero) const
+        {
+            out.resize(in.size());
+            transform(in.data(), out.data(), in.size(), translation, origin);
+        }
+
+        // SoA form of transform(), the input and output arrays may be the same.
+        // Works through blocks held in local arrays: the compute loop then only reads
+        // the inputs, so it vectorizes without the six-way run-time alias checks.
+        void transform(const value_type *inX, const value_type *inY, const value_type *inZ,
+                       value_type *outX, value_type *outY, value_type *outZ, std::size_t count,
+                       const vector_type &translation = vector_type::zero,
+                       const vector_type &origin = vector_type::zero) const
+        {
+            constexpr std::size_t blockSize = 256;
+            alignas(simdAlignment) value_type bx[blockSize], by[blockSize], bz[blockSize];
+
+            auto m00 = _row0[0], m01 = _row0[1], m02 = _row0[2];
+            auto m10 = _row1[0], m11 = _row1[1], m12 = _row1[2];
+            auto m20 = _row2[0], m21 = _row2[1], m22 = _row2[2];
+            auto tx = translation[0], ty = translation[1], tz = translation[2];
+            auto ox = origin[0], oy = origin[1], oz = origin[2];
+            for (std::size_t begin = 0; begin < count; begin += blockSize)
+            {
+                auto n = std::min(blockSize, count - begin);
+                const value_type *px = inX + begin, *py = inY + begin, *pz = inZ + begin;
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    auto x = px[i] - ox, y = py[i] - oy, z = pz[i] - oz;
+                    bx[i] = tx + m00 * x + m01 * y + m02 * z;
+                    by[i] = ty + m10 * x + m11 * y + m12 * z;
+                    bz[i] = tz + m20 * x + m21 * y + m22 * z;
+                }
+                std::copy(bx, bx + n, outX + begin);
+                std::copy(by, by + n, outY + begin);
+                std::copy(bz, bz + n, outZ + begin);
+            }
+        }
+
+        void transform(const PointSet3<T> &in, PointSet3<T> &out,
+                       const vector_type &translation = vector_type::zero,
+                       const vector_type &origin = vector_type::zero) const
+        {
+            out.resize(in.size());
+            transform(in.dataX(), in.dataY(), in.dataZ(), out.dataX(), out.dataY(), out.dataZ(),
+                      in.size(), translation, origin);
+        }
+
         bool epsilonEqual(const self_type &m, value_type epsilon) const
         {
             return _row0.epsilonEqual(m._row0, epsilon) && 
@@ -149,61 +230,60 @@ namespace g3
         }
 
         // operator functions
-        vector_type& operator [] (int r)
+        constexpr vector_type& operator [] (int r)
         { return (r == 0) ? _row0 : (r == 1) ? _row1 : _row2; }
-        vector_type  operator [] (int r) const
+        constexpr vector_type  operator [] (int r) const
         { return (r == 0) ? _row0 : (r == 1) ? _row1 : _row2; }
 
-        self_type operator - () const
+        constexpr self_type operator - () const
         { return self_type(-_row0, -_row1, -_row2, false); }
-        self_type operator - (const self_type &m) const
+        constexpr self_type operator - (const self_type &m) const
         { return self_type(_row0 - m._row0, _row1 - m._row1, _row2 - m._row2, false); }
-        self_type operator - (value_type n) const
+        constexpr self_type operator - (value_type n) const
         { return self_type(_row0 - n, _row1 - n, _row2 - n, false); }
 
-        self_type operator + (const self_type &m) const
+        constexpr self_type operator + (const self_type &m) const
         { return self_type(_row0 + m._row0, _row1 + m._row1, _row2 + m._row2, false); }
-        self_type operator + (value_type n) const
+        constexpr self_type operator + (value_type n) const
         { return self_type(_row0 + n, _row1 + n, _row2 + n, false); }
 
-        self_type operator * (const self_type &m) const
+        // row i of the product is the combination of the rows of 'm' weighted by row i
+        constexpr self_type operator * (const self_type &m) const
         {
-            auto mCol0 = m.column(0), mCol1 = m.column(1), mCol2 = m.column(2);
-            auto m00 = _row0.dot(mCol0), m01 = _row0.dot(mCol1), m02 = _row0.dot(mCol2);
-            auto m10 = _row1.dot(mCol0), m11 = _row1.dot(mCol1), m12 = _row1.dot(mCol2);
-            auto m20 = _row2.dot(mCol0), m21 = _row2.dot(mCol1), m22 = _row2.dot(mCol2);
-            return self_type(m00, m01, m02, m10, m11, m12, m20, m21, m22);
+            return self_type(m._row0 * _row0[0] + m._row1 * _row0[1] + m._row2 * _row0[2],
+                             m._row0 * _row1[0] + m._row1 * _row1[1] + m._row2 * _row1[2],
+                             m._row0 * _row2[0] + m._row1 * _row2[1] + m._row2 * _row2[2], false);
         }
-        self_type operator * (value_type n) const
+        constexpr self_type operator * (value_type n) const
         { return self_type(_row0 * n, _row1 * n, _row2 * n, false); }
-        template<typename T>
-        friend Matrix3<T> operator * (typename Matrix3<T>::value_type n, const Matrix3<T> &m);
+        template<typename U>
+        friend constexpr Matrix3<U> operator * (typename Matrix3<U>::value_type n, const Matrix3<U> &m);
 
-        self_type operator / (value_type n) const
+        constexpr self_type operator / (value_type n) const
         { return self_type(_row0 / n, _row1 / n, _row2 / n, false); }
 
-        vector_type operator * (const vector_type &v) const
+        constexpr vector_type operator * (const vector_type &v) const
         { return vector_type(_row0.dot(v), _row1.dot(v), _row2.dot(v)); }
-        template<typename T>
-        friend typename Matrix3<T>::vector_type operator * (const typename Matrix3<T>::vector_type &v, const Matrix3<T> &m);
+        template<typename U>
+        friend constexpr typename Matrix3<U>::vector_type operator * (const typename Matrix3<U>::vector_type &v, const Matrix3<U> &m);
 
     private:
         vector_type _row0, _row1, _row2;
     };
 
     template<typename T>
-    const Matrix3<T> Matrix3<T>::identity = Matrix3<T>(true);
+    inline constexpr Matrix3<T> Matrix3<T>::identity = Matrix3<T>(true);
 
     template<typename T>
-    const Matrix3<T> Matrix3<T>::zero = Matrix3<T>();
+    inline constexpr Matrix3<T> Matrix3<T>::zero = Matrix3<T>();
 
     template<typename T>
-    Matrix3<T> operator * (typename Matrix3<T>::value_type n, const Matrix3<T> &m)
+    constexpr Matrix3<T> operator * (typename Matrix3<T>::value_type n, const Matrix3<T> &m)
     { return Matrix3<T>(m._row0 * n, m._row1 * n, m._row2 * n, false); }
 
     template<typename T>
-    typename Matrix3<T>::vector_type operator * (const typename Matrix3<T>::vector_type &v, const Matrix3<T> &m)
-    { return Matrix3<T>::vector_type(v.dot(m.column(0)), v.dot(m.column(1)), v.dot(m.column(2))); }
+    constexpr typename Matrix3<T>::vector_type operator * (const typename Matrix3<T>::vector_type &v, const Matrix3<T> &m)
+    { return m._row0 * v[0] + m._row1 * v[1] + m._row2 * v[2]; }
 
     using Matrix3d = Matrix3<double>;
     using Matrix3f = Matrix3<float>;
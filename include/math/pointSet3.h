@@ -0,0 +1,237 @@
+﻿#ifndef G3_MATH_POINT_SET_3
+#define G3_MATH_POINT_SET_3
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include <type_traits>
+
+#include <core/alignedAllocator.h>
+#include <math/mathUtil.h>
+#include <math/precision.h>
+#include <math/vectorTraits.h>
+
+namespace g3
+{
+    // Structure-of-arrays storage for 3D points/vectors.
+    // x, y and z live in three separate aligned arrays, so the batch functions
+    // below are plain unit-stride loops that the compiler turns into SIMD code.
+    // Output arrays passed as raw pointers must hold at least size() values.
+    template<typename T>
+    class PointSet3
+    {
+        static_assert(std::is_floating_point<T>::value, "PointSet3 requires float or double");
+
+    public:
+        using vector_type    = typename Vector3Traits<T>::vector_type;
+        using value_type     = typename vector_type::value_type;
+        using allocator_type = AlignedAllocator<value_type>;
+        using array_type     = std::vector<value_type, allocator_type>;
+        using self_type      = PointSet3<T>;
+
+        // static functions
+        // out[i] = (1-t) * a[i] + t * b[i]
+        static void lerp(const self_type &a, const self_type &b, value_type t, self_type &out)
+        {
+            auto n = a.size();
+            out.resize(n);
+            const value_type *ax = a.dataX(), *ay = a.dataY(), *az = a.dataZ();
+            const value_type *bx = b.dataX(), *by = b.dataY(), *bz = b.dataZ();
+            value_type *ox = out.dataX(), *oy = out.dataY(), *oz = out.dataZ();
+            auto s = 1 - t;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                ox[i] = s * ax[i] + t * bx[i];
+                oy[i] = s * ay[i] + t * by[i];
+                oz[i] = s * az[i] + t * bz[i];
+            }
+        }
+
+        // out[i] = a[i] x b[i]
+        static void cross(const self_type &a, const self_type &b, self_type &out)
+        {
+            auto n = a.size();
+            out.resize(n);
+            const value_type *ax = a.dataX(), *ay = a.dataY(), *az = a.dataZ();
+            const value_type *bx = b.dataX(), *by = b.dataY(), *bz = b.dataZ();
+            value_type *ox = out.dataX(), *oy = out.dataY(), *oz = out.dataZ();
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                auto cx = ay[i] * bz[i] - az[i] * by[i];
+                auto cy = az[i] * bx[i] - ax[i] * bz[i];
+                auto cz = ax[i] * by[i] - ay[i] * bx[i];
+                ox[i] = cx; oy[i] = cy; oz[i] = cz;
+            }
+        }
+
+        // out[i] = a[i] . b[i]
+        static void dot(const self_type &a, const self_type &b, value_type *out)
+        {
+            auto n = a.size();
+            const value_type *ax = a.dataX(), *ay = a.dataY(), *az = a.dataZ();
+            const value_type *bx = b.dataX(), *by = b.dataY(), *bz = b.dataZ();
+            for (std::size_t i = 0; i < n; ++i)
+                out[i] = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i];
+        }
+
+        // constructors
+        PointSet3() {}
+        explicit PointSet3(std::size_t count) : _x(count), _y(count), _z(count) {}
+        PointSet3(const vector_type *points, std::size_t count) { gather(points, count); }
+        PointSet3(const std::vector<vector_type> &points) { gather(points); }
+
+        // functions
+        std::size_t size() const { return _x.size(); }
+        bool empty() const { return _x.empty(); }
+
+        void resize(std::size_t count) { _x.resize(count); _y.resize(count); _z.resize(count); }
+        void reserve(std::size_t count) { _x.reserve(count); _y.reserve(count); _z.reserve(count); }
+        void clear() { _x.clear(); _y.clear(); _z.clear(); }
+
+        void append(const vector_type &v)
+        { _x.push_back(v.x()); _y.push_back(v.y()); _z.push_back(v.z()); }
+
+        vector_type get(std::size_t i) const
+        { return vector_type(_x[i], _y[i], _z[i]); }
+
+        void set(std::size_t i, const vector_type &v)
+        { _x[i] = v.x(); _y[i] = v.y(); _z[i] = v.z(); }
+
+        value_type* dataX() { return _x.data(); }
+        value_type* dataY() { return _y.data(); }
+        value_type* dataZ() { return _z.data(); }
+        const value_type* dataX() const { return _x.data(); }
+        const value_type* dataY() const { return _y.data(); }
+        const value_type* dataZ() const { return _z.data(); }
+
+        // AoS -> SoA
+        void gather(const vector_type *points, std::size_t count)
+        {
+            resize(count);
+            value_type *px = _x.data(), *py = _y.data(), *pz = _z.data();
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                px[i] = points[i].x();
+                py[i] = points[i].y();
+                pz[i] = points[i].z();
+            }
+        }
+
+        void gather(const std::vector<vector_type> &points)
+        { gather(points.data(), points.size()); }
+
+        // SoA -> AoS, 'points' must hold at least size() elements
+        void scatter(vector_type *points) const
+        {
+            auto n = size();
+            const value_type *px = _x.data(), *py = _y.data(), *pz = _z.data();
+            for (std::size_t i = 0; i < n; ++i)
+                points[i].set(px[i], py[i], pz[i]);
+        }
+
+        void scatter(std::vector<vector_type> &points) const
+        {
+            points.resize(size());
+            scatter(points.data());
+        }
+
+        // out[i] = p[i] . v
+        void dot(const vector_type &v, value_type *out) const
+        {
+            auto n = size();
+            const value_type *px = _x.data(), *py = _y.data(), *pz = _z.data();
+            auto vx = v.x(), vy = v.y(), vz = v.z();
+            for (std::size_t i = 0; i < n; ++i)
+                out[i] = px[i] * vx + py[i] * vy + pz[i] * vz;
+        }
+
+        // out[i] = p[i] x v
+        void cross(const vector_type &v, self_type &out) const
+        {
+            auto n = size();
+            out.resize(n);
+            const value_type *px = _x.data(), *py = _y.data(), *pz = _z.data();
+            value_type *ox = out.dataX(), *oy = out.dataY(), *oz = out.dataZ();
+            auto vx = v.x(), vy = v.y(), vz = v.z();
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                auto cx = py[i] * vz - pz[i] * vy;
+                auto cy = pz[i] * vx - px[i] * vz;
+                auto cz = px[i] * vy - py[i] * vx;
+                ox[i] = cx; oy[i] = cy; oz[i] = cz;
+            }
+        }
+
+        void lengthSquared(value_type *out) const
+        {
+            auto n = size();
+            const value_type *px = _x.data(), *py = _y.data(), *pz = _z.data();
+            for (std::size_t i = 0; i < n; ++i)
+                out[i] = px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i];
+        }
+
+        template<typename Precision = PrecisionExact>
+        void length(value_type *out) const
+        {
+            auto n = size();
+            const value_type *px = _x.data(), *py = _y.data(), *pz = _z.data();
+            for (std::size_t i = 0; i < n; ++i)
+                out[i] = Precision::length(px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i]);
+        }
+
+        // same semantic as Vector3d::normalize<Precision>(): with a checking policy
+        // vectors not longer than epsilon become zero
+        template<typename Precision = PrecisionExact>
+        void normalize(value_type epsilon = mathUtil::getEpsilon<value_type>())
+        {
+            auto n = size();
+            value_type *px = _x.data(), *py = _y.data(), *pz = _z.data();
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                value_type len;
+                auto invLen = Precision::invLength(px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i], epsilon, len);
+                px[i] *= invLen;
+                py[i] *= invLen;
+                pz[i] *= invLen;
+            }
+        }
+
+        // out[i] = |p[i] - v|^2
+        void distanceSquared(const vector_type &v, value_type *out) const
+        {
+            auto n = size();
+            const value_type *px = _x.data(), *py = _y.data(), *pz = _z.data();
+            auto vx = v.x(), vy = v.y(), vz = v.z();
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                auto dx = px[i] - vx, dy = py[i] - vy, dz = pz[i] - vz;
+                out[i] = dx * dx + dy * dy + dz * dz;
+            }
+        }
+
+        // out[i] = |p[i] - v|
+        void distance(const vector_type &v, value_type *out) const
+        {
+            auto n = size();
+            const value_type *px = _x.data(), *py = _y.data(), *pz = _z.data();
+            auto vx = v.x(), vy = v.y(), vz = v.z();
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                auto dx = px[i] - vx, dy = py[i] - vy, dz = pz[i] - vz;
+                out[i] = std::sqrt(dx * dx + dy * dy + dz * dz);
+            }
+        }
+
+        // operator functions
+        vector_type operator [] (std::size_t i) const
+        { return get(i); }
+
+    private:
+        array_type _x, _y, _z;
+    };
+
+    using PointSet3d = PointSet3<double>;
+    using PointSet3f = PointSet3<float>;
+}
+
+#endif
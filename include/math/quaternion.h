@@ -4,6 +4,7 @@
 #include <cmath>
 
 #include <math/mathUtil.h>
+#include <math/precision.h>
 #include <math/matrix3.h>
 #include <math/vectorTraits.h>
 
@@ -13,7 +14,7 @@ namespace g3
     class Quaternion
     {
         using inner_data_type = typename Vector4Traits<T>::vector_type;
-        Quaternion(const inner_data_type &data) : _vec4(data) {}
+        constexpr Quaternion(const inner_data_type &data) : _vec4(data) {}
     public:
         using vector_type = typename Vector3Traits<T>::vector_type;
         using value_type  = typename vector_type::value_type;
@@ -38,8 +39,8 @@ namespace g3
         { return self_type(p, q, t); }
         
         // constructors
-        Quaternion() : _vec4(0, 0, 0, 1) {}
-        Quaternion(value_type x, value_type y, value_type z, value_type w) : 
+        constexpr Quaternion() : _vec4(0, 0, 0, 1) {}
+        constexpr Quaternion(value_type x, value_type y, value_type z, value_type w) : 
             _vec4(x, y, z, w) {}
         Quaternion(const vector_type &axis, value_type angle, bool isDeg = true) : Quaternion()
         { if (isDeg) setAxisAngleDeg(axis, angle); else setAxisAngleRad(axis, angle); }
@@ -56,37 +57,42 @@ namespace g3
         template<typename U>
         operator Quaternion<U>() const
         {
-            return Quaternion<U>(static_cast<typename Quaternion<U>::inner_data_type>(_vec4));
+            using u_type = typename Quaternion<U>::value_type;
+            return Quaternion<U>(static_cast<u_type>(x()), static_cast<u_type>(y()),
+                                 static_cast<u_type>(z()), static_cast<u_type>(w()));
         }
 
         // functions
-        value_type  x() const { return _vec4.x(); }
-        value_type  y() const { return _vec4.y(); }
-        value_type  z() const { return _vec4.z(); }
-        value_type  w() const { return _vec4.w(); }
-        value_type& x() { return _vec4.x(); }
-        value_type& y() { return _vec4.y(); }
-        value_type& z() { return _vec4.z(); }
-        value_type& w() { return _vec4.w(); }
-
-        value_type lengthSquared() const
+        constexpr value_type  x() const { return _vec4.x(); }
+        constexpr value_type  y() const { return _vec4.y(); }
+        constexpr value_type  z() const { return _vec4.z(); }
+        constexpr value_type  w() const { return _vec4.w(); }
+        constexpr value_type& x() { return _vec4.x(); }
+        constexpr value_type& y() { return _vec4.y(); }
+        constexpr value_type& z() { return _vec4.z(); }
+        constexpr value_type& w() { return _vec4.w(); }
+
+        constexpr value_type lengthSquared() const
         { return _vec4.lengthSquared(); }
 
         value_type length() const
         { return _vec4.length(); }
 
-        value_type dot(const self_type &q)
+        constexpr value_type dot(const self_type &q) const
         { return _vec4.dot(q._vec4); }
 
+        // Precision selects the sqrt path, see math/precision.h
+        template<typename Precision = PrecisionExact>
         value_type normalize(value_type epsilon = mathUtil::getZeroTolerance<value_type>())
         {
-            return _vec4.normalize(epsilon);
+            return _vec4.template normalize<Precision>(epsilon);
         }
 
+        template<typename Precision = PrecisionExact>
         self_type normalized() const
         {
             self_type q(*this);
-            q.normalize();
+            q.template normalize<Precision>();
             return q;
         }
 
@@ -188,7 +194,7 @@ namespace g3
 
                 auto root = std::sqrt(m[i][i] - m[j][j] - m[k][k] + 1);
 
-                value_type quat { _vec4.x(), _vec4.y(), _vec4.z() };
+                value_type quat[3] { _vec4.x(), _vec4.y(), _vec4.z() };
                 quat[i] = 0.5f * root;
                 root = 0.5f / root;
                 _vec4.w() = (m[k][j] - m[j][k]) * root;
@@ -199,7 +205,7 @@ namespace g3
             normalize();
         }
 
-        matrix_type toRotationMatrix() const
+        constexpr matrix_type toRotationMatrix() const
         {
             auto x2 = x() * 2, y2 = y() * 2, z2 = z() * 2;
             auto wx = w() * x2, wy = w() * y2, wz = w() * z2;
@@ -210,7 +216,7 @@ namespace g3
                                xz - wy, yz + wx, 1 - (xx + yy));
         }
 
-        vector_type axisX() const
+        constexpr vector_type axisX() const
         {
             auto y2 = y() * 2, z2 = z() * 2;
             auto wy = w() * y2, wz = w() * z2, xy = x() * y2;
@@ -218,7 +224,7 @@ namespace g3
             return vector_type(1 - (yy + zz), xy + wz, xz - wy);
         }
 
-        vector_type axisY() const
+        constexpr vector_type axisY() const
         {
             auto x2 = x() * 2, y2 = y() * 2, z2 = z() * 2;
             auto wx = w() * x2, wz = w() * z2, xx = x() * x2;
@@ -226,7 +232,7 @@ namespace g3
             return vector_type(xy - wz, 1 - (xx + zz), yz + wx);
         }
 
-        vector_type axisZ() const
+        constexpr vector_type axisZ() const
         {
             auto x2 = x() * 2, y2 = y() * 2, z2 = z() * 2;
             auto wx = w() * x2, wy = w() * y2, xx = x() * x2;
@@ -234,7 +240,7 @@ namespace g3
             return vector_type(xz + wy, yz - wx, 1 - (xx + yy));
         }
 
-        self_type inverse() const
+        constexpr self_type inverse() const
         {
             auto norm = lengthSquared();
             if (norm > mathUtil::getZeroTolerance<value_type>())
@@ -246,7 +252,7 @@ namespace g3
                 return zero;
         }
 
-        self_type conjugate() const
+        constexpr self_type conjugate() const
         { return self_type(-x(), -y(), -z(), w()); }
 
         bool epsilonEqual(const self_type &q, value_type eps) const
@@ -257,12 +263,12 @@ namespace g3
                    std::abs(w() - q.w()) <= eps;
         }
 
-        vector_type inverseMultiply(const vector_type &v) const
+        constexpr vector_type inverseMultiply(const vector_type &v) const
         {
             auto inv = inverse();
             if (inv != zero)
             {
-                auto mat = inv.toRotateMatrix();
+                auto mat = inv.toRotationMatrix();
                 return mat * v;
             }
             else
@@ -270,25 +276,25 @@ namespace g3
         }
 
         // operator functions
-        value_type  operator [] (int i) const
+        constexpr value_type  operator [] (int i) const
         { return _vec4[i]; }
-        value_type& operator [] (int i)
+        constexpr value_type& operator [] (int i)
         { return _vec4[i]; }
 
-        self_type operator - () const
+        constexpr self_type operator - () const
         { return self_type(-_vec4); }
 
-        self_type operator - (const self_type &q) const
+        constexpr self_type operator - (const self_type &q) const
         { return self_type(_vec4 - q._vec4); }
-        self_type operator - (value_type d) const
+        constexpr self_type operator - (value_type d) const
         { return self_type(_vec4 - d); }
 
-        self_type operator + (const self_type &q) const
+        constexpr self_type operator + (const self_type &q) const
         { return self_type(_vec4 + q._vec4); }
-        self_type operator + (value_type d) const
+        constexpr self_type operator + (value_type d) const
         { return self_type(_vec4 + d); }
 
-        self_type operator * (const self_type &q) const
+        constexpr self_type operator * (const self_type &q) const
         {
             const auto &a = _vec4;
             const auto &b = q._vec4;
@@ -299,22 +305,26 @@ namespace g3
             return self_type(x, y, z, w);
         }
 
-        self_type operator * (value_type d) const
+        constexpr self_type operator * (value_type d) const
         { return self_type(_vec4 * d); }
-        friend self_type operator * (value_type d, const self_type &q);
+        template<typename U>
+        friend constexpr Quaternion<U> operator * (typename Quaternion<U>::value_type d, const Quaternion<U> &q);
 
-        vector_type operator * (const vector_type &v) const
+        // rotates v by this unit quaternion, two cross product form:
+        // t = 2 u x v, result = v + w t + u x t, with u = (x, y, z)
+        constexpr vector_type operator * (const vector_type &v) const
         {
-            auto mat = toRotationMatrix();
-            return mat * v;
+            vector_type u(x(), y(), z());
+            auto t = u.cross(v) * 2;
+            return v + t * w() + u.cross(t);
         }
 
-        self_type operator / (value_type d) const
+        constexpr self_type operator / (value_type d) const
         { return self_type(_vec4 / d); }
 
-        bool operator == (const self_type &q) const
+        constexpr bool operator == (const self_type &q) const
         { return _vec4 == q._vec4; }
-        bool operator != (const self_type &q) const
+        constexpr bool operator != (const self_type &q) const
         { return !((*this) == q); }
 
     private:
@@ -323,14 +333,14 @@ namespace g3
     };
 
     template<typename T>
-    const Quaternion<T> Quaternion<T>::zero = Quaternion<T>(0, 0, 0, 0);
+    inline constexpr Quaternion<T> Quaternion<T>::zero = Quaternion<T>(0, 0, 0, 0);
     
     template<typename T>
-    const Quaternion<T> Quaternion<T>::indentity = Quaternion<T>();
+    inline constexpr Quaternion<T> Quaternion<T>::indentity = Quaternion<T>();
 
     template<typename T>
-    Quaternion<T> operator * (typename Quaternion<T>::value_type d,
-                              const Quaternion<T> &q)
+    constexpr Quaternion<T> operator * (typename Quaternion<T>::value_type d,
+                                        const Quaternion<T> &q)
     { return q * d; }
 
     using Quaterniond = Quaternion<double>;
@@ -0,0 +1,315 @@
+﻿#ifndef G3_MATH_QUATERNION_SET
+#define G3_MATH_QUATERNION_SET
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+#include <type_traits>
+
+#include <core/alignedAllocator.h>
+#include <math/mathUtil.h>
+#include <math/precision.h>
+#include <math/pointSet3.h>
+#include <math/quaternion.h>
+
+namespace g3
+{
+    // Slerp weight sin(t a) / sin(a) as a series in x - 1, x = cos(a) in [0, 1]:
+    // t (1 + b1 (1 + b2 (... (1 + correction * bn)))), bi = (t^2 / (i (2i + 1)) - i / (2i + 1)) (x - 1).
+    // After D. Eberly, "A Fast and Accurate Algorithm for Computing SLERP"; the
+    // correction of the last term was fitted for the minimum max error over
+    // t, x in [0, 1]: below 1e-6 with 12 terms for float, 2e-13 with 32 for double.
+    template<typename T>
+    struct SlerpSeries
+    {
+        static constexpr int terms = std::is_same<T, float>::value ? 12 : 32;
+        static constexpr T correction = std::is_same<T, float>::value ? T(1.8937223964390497) : T(1.955235065965845);
+
+        constexpr SlerpSeries() : u{}, v{}
+        {
+            for (int i = 1; i <= terms; ++i)
+            {
+                u[i - 1] = T(1) / (i * (2 * i + 1));
+                v[i - 1] = T(i) / (2 * i + 1);
+            }
+            u[terms - 1] *= correction;
+            v[terms - 1] *= correction;
+        }
+
+        T u[terms], v[terms];
+    };
+
+    // Structure-of-arrays storage for quaternions, the batch counterpart of Quaternion.
+    // x, y, z and w live in four separate aligned arrays like PointSet3. Functions that
+    // write an output set compute blocks into local arrays before storing them, so the
+    // output may be one of the inputs and the loops vectorize without alias checks.
+    // Rotation and interpolation expect unit quaternions.
+    template<typename T>
+    class QuaternionSet
+    {
+        static_assert(std::is_floating_point<T>::value, "QuaternionSet requires float or double");
+
+    public:
+        using quaternion_type = Quaternion<T>;
+        using vector_type     = typename quaternion_type::vector_type;
+        using value_type      = typename quaternion_type::value_type;
+        using point_set_type  = PointSet3<T>;
+        using allocator_type  = AlignedAllocator<value_type>;
+        using array_type      = std::vector<value_type, allocator_type>;
+        using self_type       = QuaternionSet<T>;
+
+        // static functions
+        // out[i] = a[i] * b[i]
+        static void multiply(const self_type &a, const self_type &b, self_type &out)
+        {
+            auto count = a.size();
+            out.resize(count);
+            value_type bx[blockSize], by[blockSize], bz[blockSize], bw[blockSize];
+            for (std::size_t begin = 0; begin < count; begin += blockSize)
+            {
+                auto n = std::min(blockSize, count - begin);
+                const value_type *ax = a.dataX() + begin, *ay = a.dataY() + begin, *az = a.dataZ() + begin, *aw = a.dataW() + begin;
+                const value_type *qx = b.dataX() + begin, *qy = b.dataY() + begin, *qz = b.dataZ() + begin, *qw = b.dataW() + begin;
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    bw[i] = aw[i] * qw[i] - ax[i] * qx[i] - ay[i] * qy[i] - az[i] * qz[i];
+                    bx[i] = aw[i] * qx[i] + ax[i] * qw[i] + ay[i] * qz[i] - az[i] * qy[i];
+                    by[i] = aw[i] * qy[i] + ay[i] * qw[i] + az[i] * qx[i] - ax[i] * qz[i];
+                    bz[i] = aw[i] * qz[i] + az[i] * qw[i] + ax[i] * qy[i] - ay[i] * qx[i];
+                }
+                out.store(begin, n, bx, by, bz, bw);
+            }
+        }
+
+        // Spherical interpolation out[i] = slerp(a[i], b[i], t) along the shorter arc:
+        // b[i] is negated where a[i] . b[i] < 0, unlike Quaternion::setToSlerp. The
+        // weights come from SlerpSeries instead of acos and sin, so the loop vectorizes.
+        static void slerp(const self_type &a, const self_type &b, value_type t, self_type &out)
+        { interpolate<true, PrecisionExact>(a, b, [t](std::size_t) { return t; }, out); }
+
+        // slerp() with one parameter per quaternion, t[i]
+        static void slerp(const self_type &a, const self_type &b, const value_type *t, self_type &out)
+        { interpolate<true, PrecisionExact>(a, b, [t](std::size_t i) { return t[i]; }, out); }
+
+        // Normalized linear interpolation along the shorter arc, out[i] = |(1-t) a[i] + t b[i]|;
+        // Precision selects the sqrt path, see math/precision.h
+        template<typename Precision = PrecisionExact>
+        static void nlerp(const self_type &a, const self_type &b, value_type t, self_type &out)
+        { interpolate<false, Precision>(a, b, [t](std::size_t) { return t; }, out); }
+
+        template<typename Precision = PrecisionExact>
+        static void nlerp(const self_type &a, const self_type &b, const value_type *t, self_type &out)
+        { interpolate<false, Precision>(a, b, [t](std::size_t i) { return t[i]; }, out); }
+
+        // constructors
+        QuaternionSet() {}
+        explicit QuaternionSet(std::size_t count) : _x(count), _y(count), _z(count), _w(count, 1) {}
+        QuaternionSet(const quaternion_type *quats, std::size_t count) { gather(quats, count); }
+        QuaternionSet(const std::vector<quaternion_type> &quats) { gather(quats); }
+
+        // functions
+        std::size_t size() const { return _x.size(); }
+        bool empty() const { return _x.empty(); }
+
+        // new quaternions are identities
+        void resize(std::size_t count) { _x.resize(count); _y.resize(count); _z.resize(count); _w.resize(count, 1); }
+        void reserve(std::size_t count) { _x.reserve(count); _y.reserve(count); _z.reserve(count); _w.reserve(count); }
+        void clear() { _x.clear(); _y.clear(); _z.clear(); _w.clear(); }
+
+        void append(const quaternion_type &q)
+        { _x.push_back(q.x()); _y.push_back(q.y()); _z.push_back(q.z()); _w.push_back(q.w()); }
+
+        quaternion_type get(std::size_t i) const
+        { return quaternion_type(_x[i], _y[i], _z[i], _w[i]); }
+
+        void set(std::size_t i, const quaternion_type &q)
+        { _x[i] = q.x(); _y[i] = q.y(); _z[i] = q.z(); _w[i] = q.w(); }
+
+        value_type* dataX() { return _x.data(); }
+        value_type* dataY() { return _y.data(); }
+        value_type* dataZ() { return _z.data(); }
+        value_type* dataW() { return _w.data(); }
+        const value_type* dataX() const { return _x.data(); }
+        const value_type* dataY() const { return _y.data(); }
+        const value_type* dataZ() const { return _z.data(); }
+        const value_type* dataW() const { return _w.data(); }
+
+        // AoS -> SoA
+        void gather(const quaternion_type *quats, std::size_t count)
+        {
+            resize(count);
+            value_type *px = _x.data(), *py = _y.data(), *pz = _z.data(), *pw = _w.data();
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                px[i] = quats[i].x();
+                py[i] = quats[i].y();
+                pz[i] = quats[i].z();
+                pw[i] = quats[i].w();
+            }
+        }
+
+        void gather(const std::vector<quaternion_type> &quats)
+        { gather(quats.data(), quats.size()); }
+
+        // SoA -> AoS, 'quats' must hold at least size() elements
+        void scatter(quaternion_type *quats) const
+        {
+            auto n = size();
+            const value_type *px = _x.data(), *py = _y.data(), *pz = _z.data(), *pw = _w.data();
+            for (std::size_t i = 0; i < n; ++i)
+                quats[i] = quaternion_type(px[i], py[i], pz[i], pw[i]);
+        }
+
+        void scatter(std::vector<quaternion_type> &quats) const
+        {
+            quats.resize(size());
+            scatter(quats.data());
+        }
+
+        // same semantic as Quaternion::normalize<Precision>()
+        template<typename Precision = PrecisionExact>
+        void normalize(value_type epsilon = mathUtil::getZeroTolerance<value_type>())
+        {
+            auto n = size();
+            value_type *px = _x.data(), *py = _y.data(), *pz = _z.data(), *pw = _w.data();
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                value_type len;
+                auto invLen = Precision::invLength(px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i] + pw[i] * pw[i],
+                                                   epsilon, len);
+                px[i] *= invLen;
+                py[i] *= invLen;
+                pz[i] *= invLen;
+                pw[i] *= invLen;
+            }
+        }
+
+        // out[i] = q[i] * in[i], 'out' may be 'in'
+        void rotate(const point_set_type &in, point_set_type &out) const
+        {
+            auto count = size();
+            out.resize(count);
+            value_type bx[blockSize], by[blockSize], bz[blockSize];
+            for (std::size_t begin = 0; begin < count; begin += blockSize)
+            {
+                auto n = std::min(blockSize, count - begin);
+                const value_type *qx = _x.data() + begin, *qy = _y.data() + begin, *qz = _z.data() + begin, *qw = _w.data() + begin;
+                const value_type *vx = in.dataX() + begin, *vy = in.dataY() + begin, *vz = in.dataZ() + begin;
+                for (std::size_t i = 0; i < n; ++i)
+                    rotate(qx[i], qy[i], qz[i], qw[i], vx[i], vy[i], vz[i], bx[i], by[i], bz[i]);
+                storePoints(out, begin, n, bx, by, bz);
+            }
+        }
+
+        // out[i] = q[i] * v
+        void rotate(const vector_type &v, point_set_type &out) const
+        {
+            auto count = size();
+            out.resize(count);
+            value_type bx[blockSize], by[blockSize], bz[blockSize];
+            auto vx = v.x(), vy = v.y(), vz = v.z();
+            for (std::size_t begin = 0; begin < count; begin += blockSize)
+            {
+                auto n = std::min(blockSize, count - begin);
+                const value_type *qx = _x.data() + begin, *qy = _y.data() + begin, *qz = _z.data() + begin, *qw = _w.data() + begin;
+                for (std::size_t i = 0; i < n; ++i)
+                    rotate(qx[i], qy[i], qz[i], qw[i], vx, vy, vz, bx[i], by[i], bz[i]);
+                storePoints(out, begin, n, bx, by, bz);
+            }
+        }
+
+        // operator functions
+        quaternion_type operator [] (std::size_t i) const
+        { return get(i); }
+
+    private:
+        static constexpr std::size_t blockSize = 256;
+
+        // r = q * v with the two cross product form: t = 2 u x v, r = v + w t + u x t, q = (u, w)
+        static void rotate(value_type ux, value_type uy, value_type uz, value_type w,
+                           value_type vx, value_type vy, value_type vz,
+                           value_type &rx, value_type &ry, value_type &rz)
+        {
+            auto tx = 2 * (uy * vz - uz * vy);
+            auto ty = 2 * (uz * vx - ux * vz);
+            auto tz = 2 * (ux * vy - uy * vx);
+            rx = vx + w * tx + (uy * tz - uz * ty);
+            ry = vy + w * ty + (uz * tx - ux * tz);
+            rz = vz + w * tz + (ux * ty - uy * tx);
+        }
+
+        void store(std::size_t begin, std::size_t n, const value_type *bx, const value_type *by,
+                   const value_type *bz, const value_type *bw)
+        {
+            std::copy(bx, bx + n, _x.data() + begin);
+            std::copy(by, by + n, _y.data() + begin);
+            std::copy(bz, bz + n, _z.data() + begin);
+            std::copy(bw, bw + n, _w.data() + begin);
+        }
+
+        static void storePoints(point_set_type &out, std::size_t begin, std::size_t n,
+                                const value_type *bx, const value_type *by, const value_type *bz)
+        {
+            std::copy(bx, bx + n, out.dataX() + begin);
+            std::copy(by, by + n, out.dataY() + begin);
+            std::copy(bz, bz + n, out.dataZ() + begin);
+        }
+
+        // weights of a and b from SlerpSeries, x = |a . b|
+        static void slerpWeights(value_type x, value_type t, value_type &wa, value_type &wb)
+        {
+            static constexpr SlerpSeries<value_type> series{};
+            auto xm1 = x - 1, s = 1 - t, tt = t * t, ss = s * s;
+            value_type ca = 1, cb = 1;
+            for (int k = series.terms - 1; k >= 0; --k)
+            {
+                ca = 1 + (series.u[k] * ss - series.v[k]) * xm1 * ca;
+                cb = 1 + (series.u[k] * tt - series.v[k]) * xm1 * cb;
+            }
+            wa = s * ca;
+            wb = t * cb;
+        }
+
+        template<bool Spherical, typename Precision, typename TAt>
+        static void interpolate(const self_type &a, const self_type &b, TAt tAt, self_type &out)
+        {
+            auto count = a.size();
+            out.resize(count);
+            value_type bx[blockSize], by[blockSize], bz[blockSize], bw[blockSize];
+            for (std::size_t begin = 0; begin < count; begin += blockSize)
+            {
+                auto n = std::min(blockSize, count - begin);
+                const value_type *ax = a.dataX() + begin, *ay = a.dataY() + begin, *az = a.dataZ() + begin, *aw = a.dataW() + begin;
+                const value_type *qx = b.dataX() + begin, *qy = b.dataY() + begin, *qz = b.dataZ() + begin, *qw = b.dataW() + begin;
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    auto t = tAt(begin + i);
+                    auto d = ax[i] * qx[i] + ay[i] * qy[i] + az[i] * qz[i] + aw[i] * qw[i];
+                    value_type wa, wb;
+                    if constexpr (Spherical) slerpWeights(std::abs(d), t, wa, wb);
+                    else { wa = 1 - t; wb = t; }
+                    wb *= std::copysign(value_type(1), d);
+                    auto rx = wa * ax[i] + wb * qx[i], ry = wa * ay[i] + wb * qy[i];
+                    auto rz = wa * az[i] + wb * qz[i], rw = wa * aw[i] + wb * qw[i];
+                    if constexpr (!Spherical)
+                    {
+                        value_type len;
+                        auto invLen = Precision::invLength(rx * rx + ry * ry + rz * rz + rw * rw,
+                                                           mathUtil::getZeroTolerance<value_type>(), len);
+                        rx *= invLen; ry *= invLen; rz *= invLen; rw *= invLen;
+                    }
+                    bx[i] = rx; by[i] = ry; bz[i] = rz; bw[i] = rw;
+                }
+                out.store(begin, n, bx, by, bz, bw);
+            }
+        }
+
+        array_type _x, _y, _z, _w;
+    };
+
+    using QuaternionSetd = QuaternionSet<double>;
+    using QuaternionSetf = QuaternionSet<float>;
+}
+
+#endif
@@ -45,7 +45,7 @@ namespace g3
         value_type project(const vector_type &p) const
         { return (p - _origin).dot(_direction); }
 
-        value_type distanceSquared(cosnt vector_type &p) const
+        value_type distanceSquared(const vector_type &p) const
         {
             auto t = (p - _origin).dot(_direction);
             if (t < 0)
@@ -0,0 +1,178 @@
+﻿#ifndef G3_MATH_RAY_PACKET_3
+#define G3_MATH_RAY_PACKET_3
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include <core/alignedAllocator.h>
+#include <math/mathUtil.h>
+#include <math/vectorTraits.h>
+#include <math/AxisAlignedBox3.h>
+#include <math/ray3.h>
+#include <math/triangle3.h>
+
+namespace g3
+{
+    // Bundle of up to N rays stored as structure-of-arrays, with the reciprocal
+    // directions precomputed for slab tests. Every test below runs one loop over
+    // the N lanes that the compiler turns into SIMD code, and returns a bitmask
+    // with bit i set when lane i passes. Lanes past size() never pass.
+    template<typename T, int N = 8>
+    class RayPacket3
+    {
+        static_assert(std::is_floating_point<T>::value, "RayPacket3 requires float or double");
+        static_assert(N > 0 && N <= 32, "RayPacket3 holds 1 to 32 rays");
+
+    public:
+        using vector_type   = typename Vector3Traits<T>::vector_type;
+        using value_type    = typename vector_type::value_type;
+        using ray_type      = Ray3<T>;
+        using box_type      = AxisAlignedBox3<T>;
+        using triangle_type = Triangle3<T>;
+        using mask_type     = std::uint32_t;
+        using self_type     = RayPacket3<T, N>;
+
+        // static values
+        static const int width = N;
+
+        // constructors
+        RayPacket3() : _count(0) { clear(); }
+        RayPacket3(const ray_type *rays, int count) { set(rays, count); }
+
+        // functions
+        int size() const { return _count; }
+        mask_type activeMask() const
+        { return (_count >= 32) ? ~mask_type(0) : ((mask_type(1) << _count) - 1); }
+
+        // lanes past size() get a valid dummy ray along +z
+        void clear()
+        {
+            _count = 0;
+            for (int i = 0; i < N; ++i)
+            {
+                _ox[i] = _oy[i] = _oz[i] = 0;
+                _dx[i] = _dy[i] = 0;
+                _dz[i] = 1;
+                _ix[i] = _iy[i] = std::numeric_limits<value_type>::infinity();
+                _iz[i] = 1;
+            }
+        }
+
+        // copies the first min(count, N) rays
+        void set(const ray_type *rays, int count)
+        {
+            clear();
+            _count = (count < N) ? count : N;
+            for (int i = 0; i < _count; ++i) setRay(i, rays[i]);
+        }
+
+        void setRay(int i, const ray_type &ray)
+        {
+            _ox[i] = ray.origin().x(); _oy[i] = ray.origin().y(); _oz[i] = ray.origin().z();
+            _dx[i] = ray.direction().x(); _dy[i] = ray.direction().y(); _dz[i] = ray.direction().z();
+            _ix[i] = 1 / _dx[i]; _iy[i] = 1 / _dy[i]; _iz[i] = 1 / _dz[i];
+            if (i >= _count) _count = i + 1;
+        }
+
+        vector_type origin(int i) const { return vector_type(_ox[i], _oy[i], _oz[i]); }
+        vector_type direction(int i) const { return vector_type(_dx[i], _dy[i], _dz[i]); }
+        ray_type ray(int i) const { return ray_type(origin(i), direction(i)); }
+
+        // slab test of every ray against the box [boxMin, boxMax], limited to [0, tMax[i]];
+        // tNear[i] receives the entry parameter of lane i
+        mask_type intersectBox(const value_type boxMin[3], const value_type boxMax[3],
+                               const value_type tMax[N], value_type tNear[N]) const
+        {
+            mask_type mask = 0;
+            for (int i = 0; i < N; ++i)
+            {
+                auto tx0 = (boxMin[0] - _ox[i]) * _ix[i], tx1 = (boxMax[0] - _ox[i]) * _ix[i];
+                auto ty0 = (boxMin[1] - _oy[i]) * _iy[i], ty1 = (boxMax[1] - _oy[i]) * _iy[i];
+                auto tz0 = (boxMin[2] - _oz[i]) * _iz[i], tz1 = (boxMax[2] - _oz[i]) * _iz[i];
+                auto t0 = max(max(value_type(0), min(tx0, tx1)), max(min(ty0, ty1), min(tz0, tz1)));
+                auto t1 = min(min(tMax[i], max(tx0, tx1)), min(max(ty0, ty1), max(tz0, tz1)));
+                tNear[i] = t0;
+                mask |= mask_type(t0 <= t1) << i;
+            }
+            return mask & activeMask();
+        }
+
+        mask_type intersectBox(const box_type &box, const value_type tMax[N], value_type tNear[N]) const
+        {
+            auto bmin = box.minCoordinate(), bmax = box.maxCoordinate();
+            value_type boxMin[3] = { bmin.x(), bmin.y(), bmin.z() };
+            value_type boxMax[3] = { bmax.x(), bmax.y(), bmax.z() };
+            return intersectBox(boxMin, boxMax, tMax, tNear);
+        }
+
+        // Moller-Trumbore test of every ray against 'tri', same rules as Triangle3::intersectRay.
+        // A lane only passes if its hit is closer than rayT[i], in which case rayT[i] is
+        // replaced by the hit parameter; initialize rayT with the maximum distances.
+        mask_type intersectTriangle(const triangle_type &tri, value_type rayT[N]) const
+        {
+            auto v0 = tri.v0();
+            auto e1 = tri.v1() - v0, e2 = tri.v2() - v0;
+            auto epsilon = mathUtil::getEpsilon<value_type>();
+
+            value_type hit[N];
+            for (int i = 0; i < N; ++i)
+            {
+                // pvec = d x e2
+                auto px = _dy[i] * e2.z() - _dz[i] * e2.y();
+                auto py = _dz[i] * e2.x() - _dx[i] * e2.z();
+                auto pz = _dx[i] * e2.y() - _dy[i] * e2.x();
+                auto det = e1.x() * px + e1.y() * py + e1.z() * pz;
+                auto invDet = 1 / det;
+
+                auto tx = _ox[i] - v0.x(), ty = _oy[i] - v0.y(), tz = _oz[i] - v0.z();
+                auto u = (tx * px + ty * py + tz * pz) * invDet;
+
+                // qvec = tvec x e1
+                auto qx = ty * e1.z() - tz * e1.y();
+                auto qy = tz * e1.x() - tx * e1.z();
+                auto qz = tx * e1.y() - ty * e1.x();
+                auto v = (_dx[i] * qx + _dy[i] * qy + _dz[i] * qz) * invDet;
+                auto t = (e2.x() * qx + e2.y() * qy + e2.z() * qz) * invDet;
+
+                // branch free combination of the tests, so the lane loop stays vectorized
+                int pass = (std::abs(det) >= epsilon) & (u >= 0) & (u <= 1) &
+                           (v >= 0) & (u + v <= 1) & (t >= 0) & (t < rayT[i]);
+                rayT[i] = pass ? t : rayT[i];
+                hit[i] = pass ? value_type(1) : value_type(0);
+            }
+
+            mask_type mask = 0;
+            for (int i = 0; i < N; ++i) mask |= mask_type(hit[i] != 0) << i;
+            return mask & activeMask();
+        }
+
+    private:
+        // plain selects keep the lane loops free of branches
+        static value_type min(value_type a, value_type b) { return (a < b) ? a : b; }
+        static value_type max(value_type a, value_type b) { return (a > b) ? a : b; }
+
+        alignas(simdAlignment) value_type _ox[N];
+        alignas(simdAlignment) value_type _oy[N];
+        alignas(simdAlignment) value_type _oz[N];
+        alignas(simdAlignment) value_type _dx[N];
+        alignas(simdAlignment) value_type _dy[N];
+        alignas(simdAlignment) value_type _dz[N];
+        alignas(simdAlignment) value_type _ix[N];
+        alignas(simdAlignment) value_type _iy[N];
+        alignas(simdAlignment) value_type _iz[N];
+        int _count;
+    };
+
+    template<typename T>
+    using RayPacket3x4 = RayPacket3<T, 4>;
+    template<typename T>
+    using RayPacket3x8 = RayPacket3<T, 8>;
+
+    // one 256 bit register per coordinate
+    using RayPacket3d = RayPacket3<double, 4>;
+    using RayPacket3f = RayPacket3<float, 8>;
+}
+
+#endif
@@ -0,0 +1,107 @@
+﻿#ifndef G3_MATH_SIMD_LANES
+#define G3_MATH_SIMD_LANES
+
+#include <cstddef>
+
+namespace g3
+{
+    // Fixed width register of L lanes of T, the storage and kernels of Vector<T, N>.
+    // Every operation is a loop over the compile-time lane count on aligned storage;
+    // GCC, Clang and MSVC lower these to single SSE/AVX/NEON instructions without
+    // target specific intrinsics, and they stay usable in constant expressions.
+    // Four lane registers are aligned to their full width (16 bytes for float and
+    // int, 32 bytes for double), narrower ones keep the alignment of T.
+    template<typename T, int L>
+    struct SimdLanes
+    {
+        using value_type = T;
+        using self_type  = SimdLanes<T, L>;
+
+        // static values
+        static constexpr int lanes = L;
+        static constexpr std::size_t alignment = L == 4 ? 4 * sizeof(T) : alignof(T);
+
+        // static functions
+        // 's' in the first 'n' lanes, zero in the rest
+        static constexpr self_type broadcast(value_type s, int n = L)
+        {
+            self_type r{};
+            for (int i = 0; i < n; ++i) r.v[i] = s;
+            return r;
+        }
+
+        static constexpr self_type add(const self_type &a, const self_type &b)
+        {
+            self_type r{};
+            for (int i = 0; i < L; ++i) r.v[i] = a.v[i] + b.v[i];
+            return r;
+        }
+
+        static constexpr self_type sub(const self_type &a, const self_type &b)
+        {
+            self_type r{};
+            for (int i = 0; i < L; ++i) r.v[i] = a.v[i] - b.v[i];
+            return r;
+        }
+
+        static constexpr self_type mul(const self_type &a, const self_type &b)
+        {
+            self_type r{};
+            for (int i = 0; i < L; ++i) r.v[i] = a.v[i] * b.v[i];
+            return r;
+        }
+
+        // lanes at or past 'n' are left zero, so padding never divides by zero
+        static constexpr self_type div(const self_type &a, const self_type &b, int n = L)
+        {
+            self_type r{};
+            for (int i = 0; i < n; ++i) r.v[i] = a.v[i] / b.v[i];
+            return r;
+        }
+
+        static constexpr self_type neg(const self_type &a)
+        {
+            self_type r{};
+            for (int i = 0; i < L; ++i) r.v[i] = -a.v[i];
+            return r;
+        }
+
+        static constexpr self_type abs(const self_type &a)
+        {
+            self_type r{};
+            for (int i = 0; i < L; ++i) r.v[i] = a.v[i] < 0 ? -a.v[i] : a.v[i];
+            return r;
+        }
+
+        // a * s + b, one fused step per lane where the target has FMA
+        static constexpr self_type madd(const self_type &a, value_type s, const self_type &b)
+        {
+            self_type r{};
+            for (int i = 0; i < L; ++i) r.v[i] = a.v[i] * s + b.v[i];
+            return r;
+        }
+
+        // sum of a[i] * b[i] over the first 'n' lanes
+        static constexpr value_type dot(const self_type &a, const self_type &b, int n = L)
+        {
+            value_type s = 0;
+            for (int i = 0; i < n; ++i) s += a.v[i] * b.v[i];
+            return s;
+        }
+
+        static constexpr bool equal(const self_type &a, const self_type &b, int n = L)
+        {
+            for (int i = 0; i < n; ++i)
+                if (!(a.v[i] == b.v[i])) return false;
+            return true;
+        }
+
+        // functions
+        constexpr value_type& operator [] (int i) { return v[i]; }
+        constexpr value_type  operator [] (int i) const { return v[i]; }
+
+        alignas(alignment) value_type v[L];
+    };
+}
+
+#endif
@@ -1,6 +1,7 @@
 ﻿#ifndef G3_MATH_TRANSFORM_SEQUENCE_2
 #define G3_MATH_TRANSFORM_SEQUENCE_2
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 #include <math/vectorTraits.h>
@@ -24,6 +25,12 @@ namespace g3
         virtual vector_type transformN(const vector_type &n) const = 0;
         // Apply transforms to scalar dimension
         virtual value_type transformScalar(value_type s) const = 0;
+
+        // Get the transform as p -> matrix * p + translation, with 'scale' applied to
+        // scalar dimensions. Returns false if the transform has no such form.
+        virtual bool affineForm(Matrix2<value_type> & /* matrix */, vector_type & /* translation */,
+                                value_type & /* scale */) const
+        { return false; }
     };
 
     template<typename T>
@@ -34,6 +41,7 @@ namespace g3
         using self_type   = TransformSequence2<T>;
         using vector_type = typename base_type::vector_type;
         using value_type  = typename base_type::value_type;
+        using matrix_type = Matrix2<value_type>;
 
         enum class XFormType
         {
@@ -83,7 +91,7 @@ namespace g3
             { return xform; }
         };
 
-        TransformSequence2() {}
+        TransformSequence2() : _compiled(false) {}
 
         // type conversion
 
@@ -93,7 +101,7 @@ namespace g3
             XForm xform;
             xform.type = XFormType::TRANSLATION;
             xform.data = std::make_tuple(v, vector_type::zero);
-            operations.push_back(xform);
+            pushXForm(xform);
 
             return *this;
         }
@@ -103,7 +111,7 @@ namespace g3
             XForm xform;
             xform.type = XFormType::TRANSLATION;
             xform.data = std::make_tuple(vector_type(dx, dy), vector_type::zero);
-            operations.push_back(xform);
+            pushXForm(xform);
 
             return *this;
         }
@@ -113,7 +121,7 @@ namespace g3
             XForm xform;
             xform.type = XFormType::ROTATION;
             xform.data = std::make_tuple(vector_type(angle, 0), vector_type::zero);
-            operations.push_back(xform);
+            pushXForm(xform);
 
             return *this;
         }
@@ -128,7 +136,7 @@ namespace g3
             XForm xform;
             xform.type = XFormType::ROTATE_AROUND_POINT;
             xform.data = std::make_tuple(vector_type(angle, 0), aroundPt);
-            operations.push_back(xform);
+            pushXForm(xform);
 
             return *this;
         }
@@ -143,7 +151,7 @@ namespace g3
             XForm xform;
             xform.type = XFormType::SCALE;
             xform.data = typename XForm::tuple_type(s, vector_type::zero);
-            operations.push_back(xform);
+            pushXForm(xform);
 
             return *this;
         }
@@ -152,24 +160,59 @@ namespace g3
         {
             XForm xform;
             xform.type = XFormType::SCALE_AROUND_POINT;
-            xform.data = typename xform::tuple_type(s, aroundPt);
-            operations.push_back(xform);
+            xform.data = typename XForm::tuple_type(s, aroundPt);
+            pushXForm(xform);
 
             return *this;
         }
 
+        // Fold the sequence into cached affine steps (nested transforms that have an
+        // affine form are folded too, the others stay as barriers). Operations appended
+        // afterwards are folded into the cache as they come, so transforming a point costs
+        // one step per barrier instead of one per operation.
+        // Nested transforms are sampled here: call compile() again if they are modified.
+        void compile()
+        {
+            _steps = affineSteps();
+            _compiled = true;
+        }
+
+        bool isCompiled() const { return _compiled; }
+
+        bool affineForm(matrix_type &matrix, vector_type &translation, value_type &scale) const override
+        {
+            std::vector<AffineStep> scratch;
+            const auto &steps = compiledSteps(scratch);
+            if (steps.size() != 1) return false;
+            matrix = steps[0].matrix;
+            translation = steps[0].translation;
+            scale = steps[0].scale;
+            return true;
+        }
+
         self_type& append(std::shared_ptr<base_type> t2)
         {
             XForm xform;
             xform.type = XFormType::NESTED_ITRANSFORM2;
             xform.xform = t2;
-            operations.push_back(xform);
+            pushXForm(xform);
 
             return *this;
         }
 
         vector_type transformP(const vector_type &p) const override
         {
+            if (_compiled)
+            {
+                auto r = p;
+                for (const auto &step : _steps)
+                {
+                    r = step.matrix * r + step.translation;
+                    if (step.nested) r = step.nested->transformP(r);
+                }
+                return r;
+            }
+
             auto r = p;
             for (const auto &op : operations)
             {
@@ -214,6 +257,17 @@ namespace g3
 
         vector_type transformN(const vector_type &n) const override
         {
+            if (_compiled)
+            {
+                auto r = n;
+                for (const auto &step : _steps)
+                {
+                    r = step.matrix * r;
+                    if (step.nested) r = step.nested->transformN(r);
+                }
+                return r;
+            }
+
             auto r = n;
             for (const auto &op : operations)
             {
@@ -231,6 +285,7 @@ namespace g3
                 case XFormType::SCALE_AROUND_POINT:
                     // TO UPDATE: 当前没有判断 op.scaleUniform() 是否为真
                     r = r * op.scale();
+                    break;
 
                 case XFormType::NESTED_ITRANSFORM2:
                     r = op.nestedITransform2()->transformN(r);
@@ -247,6 +302,17 @@ namespace g3
 
         value_type transformScalar(value_type s) const override
         {
+            if (_compiled)
+            {
+                auto r = s;
+                for (const auto &step : _steps)
+                {
+                    r = r * step.scale;
+                    if (step.nested) r = step.nested->transformScalar(r);
+                }
+                return r;
+            }
+
             auto r = s;
             for (const auto &op : operations)
             {
@@ -276,9 +342,217 @@ namespace g3
             return r;
         }
 
+        // Apply transforms to 'count' points, 'in' and 'out' may be the same buffer.
+        // Runs of non-nested operations are collapsed into one affine form first,
+        // so the cost per point does not grow with the length of the sequence.
+        void transformP(const vector_type *in, vector_type *out, std::size_t count) const
+        {
+            std::vector<AffineStep> scratch;
+            const vector_type *src = in;
+            for (const auto &step : compiledSteps(scratch))
+            {
+                if (!step.identity)
+                {
+                    auto m00 = step.matrix[0][0], m01 = step.matrix[0][1];
+                    auto m10 = step.matrix[1][0], m11 = step.matrix[1][1];
+                    auto tx = step.translation.x(), ty = step.translation.y();
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        auto x = src[i].x(), y = src[i].y();
+                        out[i].set(m00 * x + m01 * y + tx, m10 * x + m11 * y + ty);
+                    }
+                    src = out;
+                }
+                if (step.nested)
+                {
+                    for (std::size_t i = 0; i < count; ++i) out[i] = step.nested->transformP(src[i]);
+                    src = out;
+                }
+            }
+            if (src != out)
+                for (std::size_t i = 0; i < count; ++i) out[i] = src[i];
+        }
+
+        void transformP(const std::vector<vector_type> &in, std::vector<vector_type> &out) const
+        {
+            out.resize(in.size());
+            transformP(in.data(), out.data(), in.size());
+        }
+
+        // Apply transforms to 'count' normalized vectors, 'in' and 'out' may be the same buffer
+        void transformN(const vector_type *in, vector_type *out, std::size_t count) const
+        {
+            std::vector<AffineStep> scratch;
+            const vector_type *src = in;
+            for (const auto &step : compiledSteps(scratch))
+            {
+                if (!step.identity)
+                {
+                    auto m00 = step.matrix[0][0], m01 = step.matrix[0][1];
+                    auto m10 = step.matrix[1][0], m11 = step.matrix[1][1];
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        auto x = src[i].x(), y = src[i].y();
+                        out[i].set(m00 * x + m01 * y, m10 * x + m11 * y);
+                    }
+                    src = out;
+                }
+                if (step.nested)
+                {
+                    for (std::size_t i = 0; i < count; ++i) out[i] = step.nested->transformN(src[i]);
+                    src = out;
+                }
+            }
+            if (src != out)
+                for (std::size_t i = 0; i < count; ++i) out[i] = src[i];
+        }
+
+        void transformN(const std::vector<vector_type> &in, std::vector<vector_type> &out) const
+        {
+            out.resize(in.size());
+            transformN(in.data(), out.data(), in.size());
+        }
+
+        // Apply transforms to 'count' scalar dimensions, 'in' and 'out' may be the same buffer
+        void transformScalar(const value_type *in, value_type *out, std::size_t count) const
+        {
+            std::vector<AffineStep> scratch;
+            const value_type *src = in;
+            for (const auto &step : compiledSteps(scratch))
+            {
+                if (!step.identity)
+                {
+                    auto s = step.scale;
+                    for (std::size_t i = 0; i < count; ++i) out[i] = src[i] * s;
+                    src = out;
+                }
+                if (step.nested)
+                {
+                    for (std::size_t i = 0; i < count; ++i) out[i] = step.nested->transformScalar(src[i]);
+                    src = out;
+                }
+            }
+            if (src != out)
+                for (std::size_t i = 0; i < count; ++i) out[i] = src[i];
+        }
+
+        void transformScalar(const std::vector<value_type> &in, std::vector<value_type> &out) const
+        {
+            out.resize(in.size());
+            transformScalar(in.data(), out.data(), in.size());
+        }
+
     private:
+        // affine form (matrix * p + translation) of a run of non-nested operations,
+        // followed by the nested transform that ended the run (if any)
+        struct AffineStep
+        {
+            matrix_type matrix = matrix_type(true);
+            vector_type translation;
+            value_type scale = 1;   // accumulated factor applied by transformScalar()
+            bool identity = true;
+            std::shared_ptr<base_type> nested;
+        };
+
+        static void foldXForm(const XForm &op, AffineStep &step)
+        {
+            switch (op.type)
+            {
+            case XFormType::TRANSLATION:
+                step.translation = step.translation + op.translation();
+                break;
+
+            case XFormType::ROTATION:
+            {
+                auto rot = op.rotation();
+                step.matrix = rot * step.matrix;
+                step.translation = rot * step.translation;
+            }
+                break;
+
+            case XFormType::ROTATE_AROUND_POINT:
+            {
+                auto rot = op.rotation();
+                step.matrix = rot * step.matrix;
+                step.translation = rot * (step.translation - op.rotateOrigin()) + op.rotateOrigin();
+            }
+                break;
+
+            case XFormType::SCALE:
+            {
+                auto s = op.scale();
+                step.matrix = matrix_type(s.x(), s.y()) * step.matrix;
+                step.translation = step.translation * s;
+                step.scale *= s.x();
+            }
+                break;
+
+            case XFormType::SCALE_AROUND_POINT:
+            {
+                auto s = op.scale();
+                step.matrix = matrix_type(s.x(), s.y()) * step.matrix;
+                step.translation = (step.translation - op.rotateOrigin()) * s + op.rotateOrigin();
+                step.scale *= s.x();
+            }
+                break;
+
+            default:
+                return;
+            }
+            step.identity = false;
+        }
+
+        static void appendStep(std::vector<AffineStep> &steps, const XForm &op)
+        {
+            if (op.type != XFormType::NESTED_ITRANSFORM2)
+            {
+                foldXForm(op, steps.back());
+                return;
+            }
+
+            auto &step = steps.back();
+            matrix_type m;
+            vector_type t;
+            value_type s;
+            if (op.nestedITransform2()->affineForm(m, t, s))
+            {
+                step.matrix = m * step.matrix;
+                step.translation = m * step.translation + t;
+                step.scale *= s;
+                step.identity = false;
+            }
+            else
+            {
+                step.nested = op.nestedITransform2();
+                steps.emplace_back();
+            }
+        }
+
+        // collapse the operation list into affine steps, non-affine nested transforms act as barriers
+        std::vector<AffineStep> affineSteps() const
+        {
+            std::vector<AffineStep> steps(1);
+            for (const auto &op : operations) appendStep(steps, op);
+            return steps;
+        }
+
+        const std::vector<AffineStep>& compiledSteps(std::vector<AffineStep> &scratch) const
+        {
+            if (_compiled) return _steps;
+            scratch = affineSteps();
+            return scratch;
+        }
+
+        void pushXForm(const XForm &xform)
+        {
+            operations.push_back(xform);
+            if (_compiled) appendStep(_steps, xform);
+        }
 
         std::vector<XForm> operations;
+
+        bool _compiled;
+        std::vector<AffineStep> _steps;
     };
 
     template<typename T>
@@ -1,7 +1,11 @@
 ﻿#ifndef G3_MATH_TRIANGLE_3
 #define G3_MATH_TRIANGLE_3
 
+#include <cmath>
+
 #include <math/vectorTraits.h>
+#include <math/AxisAlignedBox3.h>
+#include <math/ray3.h>
 
 namespace g3
 {
@@ -42,6 +46,71 @@ namespace g3
         vector_type barycentricCoords(const vector_type &point)
         { return mathUtil::barycentricCoords<vector_type>(point, _v0, _v1, _v2); }
 
+        AxisAlignedBox3<T> bounds() const
+        {
+            AxisAlignedBox3<T> box(_v0);
+            box.contain(_v1);
+            box.contain(_v2);
+            return box;
+        }
+
+        // Closest point on the triangle (boundary included) to 'p'.
+        // Voronoi region walk from Ericson, Real-Time Collision Detection 5.1.5
+        vector_type closestPoint(const vector_type &p) const
+        {
+            auto ab = _v1 - _v0, ac = _v2 - _v0, ap = p - _v0;
+            auto d1 = ab.dot(ap), d2 = ac.dot(ap);
+            if (d1 <= 0 && d2 <= 0) return _v0;
+
+            auto bp = p - _v1;
+            auto d3 = ab.dot(bp), d4 = ac.dot(bp);
+            if (d3 >= 0 && d4 <= d3) return _v1;
+
+            auto vc = d1 * d4 - d3 * d2;
+            if (vc <= 0 && d1 >= 0 && d3 <= 0) return _v0 + ab * (d1 / (d1 - d3));
+
+            auto cp = p - _v2;
+            auto d5 = ab.dot(cp), d6 = ac.dot(cp);
+            if (d6 >= 0 && d5 <= d6) return _v2;
+
+            auto vb = d5 * d2 - d1 * d6;
+            if (vb <= 0 && d2 >= 0 && d6 <= 0) return _v0 + ac * (d2 / (d2 - d6));
+
+            auto va = d3 * d6 - d5 * d4;
+            if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+                return _v1 + (_v2 - _v1) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+            auto denom = 1 / (va + vb + vc);
+            return _v0 + ab * (vb * denom) + ac * (vc * denom);
+        }
+
+        value_type distanceSquared(const vector_type &p) const
+        { return closestPoint(p).distanceSquared(p); }
+
+        // Moller-Trumbore ray/triangle test, both sides of the triangle are hit.
+        // On hit 'rayT' is the ray parameter of the hit point.
+        bool intersectRay(const Ray3<T> &ray, value_type &rayT) const
+        {
+            auto e1 = _v1 - _v0, e2 = _v2 - _v0;
+            auto pvec = ray.direction().cross(e2);
+            auto det = e1.dot(pvec);
+            if (std::abs(det) < mathUtil::getEpsilon<value_type>()) return false;
+
+            auto invDet = 1 / det;
+            auto tvec = ray.origin() - _v0;
+            auto u = tvec.dot(pvec) * invDet;
+            if (u < 0 || u > 1) return false;
+
+            auto qvec = tvec.cross(e1);
+            auto v = ray.direction().dot(qvec) * invDet;
+            if (v < 0 || u + v > 1) return false;
+
+            auto t = e2.dot(qvec) * invDet;
+            if (t < 0) return false;
+            rayT = t;
+            return true;
+        }
+
         // operators
         vector_type  operator [] (int i) const
         { return (i == 0) ? _v0 : (i == 1) ? _v1 : _v2; }
@@ -0,0 +1,331 @@
+﻿#ifndef G3_MATH_VECTOR
+#define G3_MATH_VECTOR
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include <math/mathUtil.h>
+#include <math/precision.h>
+#include <math/simdLanes.h>
+
+namespace g3
+{
+    // N component vector of T stored in L >= N lanes of a SimdLanes register.
+    // Vector2d ... Vector4f are aliases of this template. Lanes past N are padding:
+    // they are always zero, so element-wise kernels and reductions run over all L
+    // lanes and compile to full width vector instructions. Vector4f and Vector4d
+    // are 16 and 32 byte aligned; Vector3f keeps its packed 12 byte layout for
+    // vertex buffers and files, Vector3fPadded is the 16 byte aligned variant.
+    template<typename T, int N, int L = N>
+    class Vector
+    {
+        static_assert(N >= 2 && N <= 4, "Vector supports 2, 3 and 4 components");
+        static_assert(L >= N, "Vector needs at least N lanes");
+
+    public:
+        using value_type  = T;
+        using self_type   = Vector<T, N, L>;
+        using lanes_type  = SimdLanes<T, L>;
+        using asso_type_2 = Vector<T, 2>;
+
+        // static values
+        static constexpr int dimension = N;
+        static constexpr int lanes = L;
+
+        static const self_type zero;
+        static const self_type one;
+        static const self_type oneNormalized;
+        static const self_type axisX;
+        static const self_type axisY;
+        static const self_type axisZ;
+        static const self_type axisW;
+        static const self_type maxValue;
+        static const self_type minValue;
+        static const self_type invalid;
+
+        // static functions
+        static self_type fromAngleRed(value_type angle)
+        {
+            static_assert(N == 2, "fromAngleRed needs a 2D vector");
+            return self_type(std::cos(angle), std::sin(angle));
+        }
+        static self_type fromAngleDeg(value_type angle)
+        { angle *= mathUtil::getDeg2Rad<value_type>(); return fromAngleRed(angle); }
+
+        static constexpr value_type dot(const self_type &v1, const self_type &v2)
+        { return v1.dot(v2); }
+        // scalar for 2D vectors, vector for 3D vectors
+        static constexpr auto cross(const self_type &v1, const self_type &v2)
+        { return v1.cross(v2); }
+
+        static value_type angleD(const self_type &v1, const self_type &v2)
+        { return v1.angleD(v2); }
+        static value_type angleR(const self_type &v1, const self_type &v2)
+        { return v1.angleR(v2); }
+
+        static constexpr self_type lerp(const self_type &a, const self_type &b, value_type t)
+        { return self_type(lanes_type::madd(b._v, t, lanes_type::mul(a._v, lanes_type::broadcast(1 - t)))); }
+
+        // constructors
+        constexpr Vector() : _v{} {}
+        constexpr Vector(value_type d) : _v(lanes_type::broadcast(d, N)) {}
+
+        template<int M = N, typename std::enable_if<M == 2, int>::type = 0>
+        constexpr Vector(value_type x, value_type y) : _v{{x, y}} {}
+        template<int M = N, typename std::enable_if<M == 3, int>::type = 0>
+        constexpr Vector(value_type x, value_type y, value_type z) : _v{{x, y, z}} {}
+        template<int M = N, typename std::enable_if<M == 4, int>::type = 0>
+        constexpr Vector(value_type x, value_type y, value_type z, value_type w) : _v{{x, y, z, w}} {}
+
+        constexpr Vector(const value_type vals[]) : _v{}
+        { for (int i = 0; i < N; ++i) _v[i] = vals[i]; }
+
+        explicit constexpr Vector(const lanes_type &v) : _v(v) {}
+
+        // type conversion
+        // implicit between element types and lane counts, explicit from floating point to integer
+        template<typename U, int M, typename std::enable_if<
+            !(std::is_same<U, T>::value && M == L) && !(std::is_floating_point<U>::value && std::is_integral<T>::value), int>::type = 0>
+        constexpr Vector(const Vector<U, N, M> &v) : _v{}
+        { for (int i = 0; i < N; ++i) _v[i] = static_cast<value_type>(v[i]); }
+
+        template<typename U, int M, typename std::enable_if<
+            std::is_floating_point<U>::value && std::is_integral<T>::value, int>::type = 0>
+        explicit constexpr Vector(const Vector<U, N, M> &v) : _v{}
+        { for (int i = 0; i < N; ++i) _v[i] = static_cast<value_type>(v[i]); }
+
+        // functions
+        constexpr value_type& x() { return _v[0]; }
+        constexpr value_type& y() { return _v[1]; }
+        constexpr value_type& z() { static_assert(N > 2, "z() needs a 3D or 4D vector"); return _v[2]; }
+        constexpr value_type& w() { static_assert(N > 3, "w() needs a 4D vector"); return _v[3]; }
+        constexpr value_type  x() const { return _v[0]; }
+        constexpr value_type  y() const { return _v[1]; }
+        constexpr value_type  z() const { static_assert(N > 2, "z() needs a 3D or 4D vector"); return _v[2]; }
+        constexpr value_type  w() const { static_assert(N > 3, "w() needs a 4D vector"); return _v[3]; }
+
+        constexpr asso_type_2 xy() const { return asso_type_2(_v[0], _v[1]); }
+        constexpr void xy(const asso_type_2 &v) { _v[0] = v.x(); _v[1] = v.y(); }
+
+        constexpr asso_type_2 xz() const { return asso_type_2(_v[0], z()); }
+        constexpr void xz(const asso_type_2 &v) { _v[0] = v.x(); z() = v.y(); }
+
+        constexpr asso_type_2 yz() const { return asso_type_2(_v[1], z()); }
+        constexpr void yz(const asso_type_2 &v) { _v[1] = v.x(); z() = v.y(); }
+
+        // the lane register, padding lanes included
+        constexpr const lanes_type& lanesData() const { return _v; }
+        constexpr const value_type* data() const { return _v.v; }
+        constexpr value_type* data() { return _v.v; }
+
+        constexpr value_type lengthSquared() const { return lanes_type::dot(_v, _v); }
+        template<typename Precision = PrecisionExact>
+        value_type length() const { return Precision::length(lengthSquared()); }
+        value_type lengthL1() const
+        {
+            value_type s = 0;
+            for (int i = 0; i < N; ++i) s += std::abs(_v[i]);
+            return s;
+        }
+
+        value_type max() const
+        {
+            auto r = _v[0];
+            for (int i = 1; i < N; ++i) r = std::fmax(r, _v[i]);
+            return r;
+        }
+        value_type min() const
+        {
+            auto r = _v[0];
+            for (int i = 1; i < N; ++i) r = std::fmin(r, _v[i]);
+            return r;
+        }
+
+        value_type maxAbs() const
+        {
+            auto r = std::abs(_v[0]);
+            for (int i = 1; i < N; ++i) r = std::fmax(r, std::abs(_v[i]));
+            return r;
+        }
+        value_type minAbs() const
+        {
+            auto r = std::abs(_v[0]);
+            for (int i = 1; i < N; ++i) r = std::fmin(r, std::abs(_v[i]));
+            return r;
+        }
+
+        constexpr self_type abs() const { return self_type(lanes_type::abs(_v)); }
+
+        // Precision selects the sqrt path, see math/precision.h
+        template<typename Precision = PrecisionExact>
+        value_type normalize(value_type epsilon = mathUtil::getEpsilon<value_type>())
+        {
+            value_type len;
+            auto invLen = Precision::invLength(lengthSquared(), epsilon, len);
+            _v = lanes_type::mul(_v, lanes_type::broadcast(invLen));
+            return len;
+        }
+
+        template<typename Precision = PrecisionExact>
+        self_type normalized() const
+        {
+            value_type len;
+            auto invLen = Precision::invLength(lengthSquared(), mathUtil::getEpsilon<value_type>(), len);
+            return self_type(lanes_type::mul(_v, lanes_type::broadcast(invLen)));
+        }
+
+        bool isNormalized() const
+        { return std::abs(lengthSquared() - 1) < mathUtil::getZeroTolerance<value_type>(); }
+
+        // TODO: realize function 'Vector::round()'
+        void round(int decimals)
+        { }
+
+        constexpr value_type dot(const self_type &v) const { return lanes_type::dot(_v, v._v); }
+
+        // scalar for 2D vectors, vector for 3D vectors
+        constexpr auto cross(const self_type &v) const
+        {
+            static_assert(N == 2 || N == 3, "cross needs a 2D or 3D vector");
+            if constexpr (N == 2) return _v[0] * v._v[1] - _v[1] * v._v[0];
+            else return self_type(_v[1] * v._v[2] - _v[2] * v._v[1],
+                                  _v[2] * v._v[0] - _v[0] * v._v[2],
+                                  _v[0] * v._v[1] - _v[1] * v._v[0]);
+        }
+
+        self_type unitCross(const self_type &v) const
+        { return cross(v).normalized(); }
+
+        constexpr value_type dotPerp(const self_type &v) const { return cross(v); }
+
+        constexpr self_type perp() const
+        {
+            static_assert(N == 2, "perp needs a 2D vector");
+            return self_type(_v[1], -_v[0]);
+        }
+        self_type unitPerp() const { return perp().normalized(); }
+
+        value_type angleD(const self_type &v) const
+        { return angleR(v) * mathUtil::getRad2Deg<value_type>(); }
+
+        value_type angleR(const self_type &v) const
+        {
+            auto fDot = mathUtil::clamp(dot(v), static_cast<value_type>(-1), static_cast<value_type>(1));
+            return std::acos(fDot);
+        }
+
+        constexpr value_type distanceSquared(const self_type &v) const
+        {
+            auto d = lanes_type::sub(_v, v._v);
+            return lanes_type::dot(d, d);
+        }
+
+        template<typename Precision = PrecisionExact>
+        value_type distance(const self_type &v) const
+        { return Precision::length(distanceSquared(v)); }
+
+        constexpr void set(const self_type &v) { _v = v._v; }
+        template<typename... Args>
+        constexpr void set(value_type x, Args... rest) { *this = self_type(x, static_cast<value_type>(rest)...); }
+
+        constexpr void add(const self_type &v) { _v = lanes_type::add(_v, v._v); }
+        constexpr void subtract(const self_type &v) { _v = lanes_type::sub(_v, v._v); }
+
+        constexpr bool equals(const self_type &v) const
+        { return (*this) == v; }
+        bool epsilonEqual(const self_type &v, value_type eps) const
+        {
+            for (int i = 0; i < N; ++i)
+                if (!(std::abs(_v[i] - v._v[i]) <= eps)) return false;
+            return true;
+        }
+
+        // operator functions
+        constexpr value_type& operator [] (int i) { return _v[i]; }
+        constexpr value_type  operator [] (int i) const { return _v[i]; }
+
+        constexpr self_type operator - () const { return self_type(lanes_type::neg(_v)); }
+
+        constexpr self_type operator - (const self_type &v) const
+        { return self_type(lanes_type::sub(_v, v._v)); }
+        constexpr self_type operator - (value_type d) const
+        { return self_type(lanes_type::sub(_v, lanes_type::broadcast(d, N))); }
+
+        constexpr self_type operator + (const self_type &v) const
+        { return self_type(lanes_type::add(_v, v._v)); }
+        constexpr self_type operator + (value_type d) const
+        { return self_type(lanes_type::add(_v, lanes_type::broadcast(d, N))); }
+        friend constexpr self_type operator + (value_type d, const self_type &v)
+        { return v + d; }
+
+        constexpr self_type operator * (const self_type &v) const
+        { return self_type(lanes_type::mul(_v, v._v)); }
+
+        constexpr self_type operator * (value_type d) const
+        { return self_type(lanes_type::mul(_v, lanes_type::broadcast(d, N))); }
+        friend constexpr self_type operator * (value_type d, const self_type &v)
+        { return v * d; }
+
+        constexpr self_type operator / (const self_type &v) const
+        { return self_type(lanes_type::div(_v, v._v, N)); }
+
+        constexpr self_type operator / (value_type d) const
+        { return self_type(lanes_type::div(_v, lanes_type::broadcast(d, N), N)); }
+        friend constexpr self_type operator / (value_type d, const self_type &v)
+        { return self_type(lanes_type::div(lanes_type::broadcast(d, N), v._v, N)); }
+
+        constexpr bool operator == (const self_type &v) const
+        { return lanes_type::equal(_v, v._v); }
+        constexpr bool operator != (const self_type &v) const
+        { return !((*this) == v); }
+
+    private:
+        // axisZ and axisW only exist for vectors with that many components
+        template<int I>
+        static constexpr self_type unitAxis()
+        {
+            static_assert(I < N, "Vector: unit axis beyond the vector's components (axisZ needs N >= 3, axisW N == 4)");
+            self_type r;
+            if constexpr (I < N) r._v[I] = 1;
+            return r;
+        }
+
+        lanes_type _v;
+    };
+
+    template<typename T, int N, int L>
+    inline constexpr Vector<T, N, L> Vector<T, N, L>::zero = Vector<T, N, L>();
+    template<typename T, int N, int L>
+    inline constexpr Vector<T, N, L> Vector<T, N, L>::one = Vector<T, N, L>(1);
+    template<typename T, int N, int L>
+    inline constexpr Vector<T, N, L> Vector<T, N, L>::oneNormalized =
+        Vector<T, N, L>(static_cast<T>(N == 2 ? mathUtil::sqrtTwoInv : N == 3 ? mathUtil::sqrtThree / 3.0 : 0.5));
+    template<typename T, int N, int L>
+    inline constexpr Vector<T, N, L> Vector<T, N, L>::axisX = Vector<T, N, L>::template unitAxis<0>();
+    template<typename T, int N, int L>
+    inline constexpr Vector<T, N, L> Vector<T, N, L>::axisY = Vector<T, N, L>::template unitAxis<1>();
+    template<typename T, int N, int L>
+    inline constexpr Vector<T, N, L> Vector<T, N, L>::axisZ = Vector<T, N, L>::template unitAxis<2>();
+    template<typename T, int N, int L>
+    inline constexpr Vector<T, N, L> Vector<T, N, L>::axisW = Vector<T, N, L>::template unitAxis<3>();
+    template<typename T, int N, int L>
+    inline constexpr Vector<T, N, L> Vector<T, N, L>::maxValue = Vector<T, N, L>(std::numeric_limits<T>::max());
+    template<typename T, int N, int L>
+    inline constexpr Vector<T, N, L> Vector<T, N, L>::minValue = Vector<T, N, L>(std::numeric_limits<T>::min());
+    template<typename T, int N, int L>
+    inline constexpr Vector<T, N, L> Vector<T, N, L>::invalid = Vector<T, N, L>::maxValue;
+
+    using Vector2d = Vector<double, 2>;
+    using Vector2f = Vector<float, 2>;
+    using Vector2i = Vector<int, 2>;
+    using Vector3d = Vector<double, 3>;
+    using Vector3f = Vector<float, 3>;
+    using Vector3i = Vector<int, 3>;
+    using Vector4d = Vector<double, 4>;
+    using Vector4f = Vector<float, 4>;
+
+    using Vector3fPadded = Vector<float, 3, 4>;
+}
+
+#endif
@@ -0,0 +1,556 @@
+﻿#ifndef G3_MESH_D_MESH_3
+#define G3_MESH_D_MESH_3
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <core/alignedAllocator.h>
+#include <math/vectorTraits.h>
+#include <math/indexType.h>
+#include <math/IndexUtil.h>
+#include <math/pointSet3.h>
+#include <math/triangle3.h>
+#include <math/AxisAlignedBox3.h>
+#include <mesh/refCountVector.h>
+#include <mesh/smallListSet.h>
+
+namespace g3
+{
+    // Dynamic indexed triangle mesh, after g3Sharp DMesh3.
+    // Every attribute lives in its own contiguous array indexed by element id:
+    // positions and the optional normals/colors as SoA point sets, UVs as two
+    // float arrays, triangles as packed Index3. Deleted ids go to a free list and
+    // are reused by later appends, so ids stay stable and nothing is allocated per
+    // element. The vertex reference count is 1 + the number of triangles using it.
+    //
+    // Edge topology is kept up to date by every edit: edge -> vertices (ordered
+    // a < b) and edge -> triangles as Index2, triangle -> edges as Index3 (edge j
+    // joins corners j and j+1), and vertex -> edges in a SmallListSet. A boundary
+    // edge has an invalid second triangle. One-ring and edge queries only read
+    // these tables and never allocate.
+    template<typename T>
+    class DMesh3
+    {
+    public:
+        using vector_type   = typename Vector3Traits<T>::vector_type;
+        using value_type    = typename vector_type::value_type;
+        using normal_type   = Vector3f;
+        using color_type    = Vector3f;
+        using uv_type       = Vector2f;
+        using index_type    = Index3;
+        using box_type      = AxisAlignedBox3<T>;
+        using triangle_type = Triangle3<T>;
+        using self_type     = DMesh3<T>;
+
+        // optional per element data
+        enum Components : unsigned
+        {
+            NoComponents   = 0,
+            VertexNormals  = 1,
+            VertexColors   = 2,
+            VertexUVs      = 4,
+            TriangleGroups = 8
+        };
+
+        // static values
+        static constexpr int invalidID = -1;
+        static constexpr int nonManifoldID = -2;
+
+        // constructors
+        DMesh3(unsigned components = NoComponents) : _components(NoComponents)
+        {
+            if (components & VertexNormals) enableVertexNormals();
+            if (components & VertexColors) enableVertexColors();
+            if (components & VertexUVs) enableVertexUVs();
+            if (components & TriangleGroups) enableTriangleGroups();
+        }
+
+        // functions
+        unsigned components() const { return _components; }
+        bool hasVertexNormals() const { return (_components & VertexNormals) != 0; }
+        bool hasVertexColors() const { return (_components & VertexColors) != 0; }
+        bool hasVertexUVs() const { return (_components & VertexUVs) != 0; }
+        bool hasTriangleGroups() const { return (_components & TriangleGroups) != 0; }
+
+        void enableVertexNormals(const normal_type &initial = normal_type(0, 1, 0))
+        {
+            if (hasVertexNormals()) return;
+            _normals.resize(maxVertexID());
+            fill(_normals, initial);
+            _components |= VertexNormals;
+        }
+
+        void enableVertexColors(const color_type &initial = color_type(1, 1, 1))
+        {
+            if (hasVertexColors()) return;
+            _colors.resize(maxVertexID());
+            fill(_colors, initial);
+            _components |= VertexColors;
+        }
+
+        void enableVertexUVs(const uv_type &initial = uv_type(0, 0))
+        {
+            if (hasVertexUVs()) return;
+            _u.assign(maxVertexID(), initial.x());
+            _v.assign(maxVertexID(), initial.y());
+            _components |= VertexUVs;
+        }
+
+        void enableTriangleGroups(int initial = 0)
+        {
+            if (hasTriangleGroups()) return;
+            _groups.assign(maxTriangleID(), initial);
+            _components |= TriangleGroups;
+        }
+
+        void discardVertexNormals() { _normals.clear(); _components &= ~unsigned(VertexNormals); }
+        void discardVertexColors() { _colors.clear(); _components &= ~unsigned(VertexColors); }
+        void discardVertexUVs() { _u.clear(); _v.clear(); _components &= ~unsigned(VertexUVs); }
+        void discardTriangleGroups() { _groups.clear(); _components &= ~unsigned(TriangleGroups); }
+
+        // live element counts
+        std::size_t vertexCount() const { return _vertexRefs.count(); }
+        std::size_t triangleCount() const { return _triangleRefs.count(); }
+        std::size_t edgeCount() const { return _edgeRefs.count(); }
+
+        // size of the id spaces, live ids are below these values
+        int maxVertexID() const { return static_cast<int>(_vertexRefs.maxIndex()); }
+        int maxTriangleID() const { return static_cast<int>(_triangleRefs.maxIndex()); }
+        int maxEdgeID() const { return static_cast<int>(_edgeRefs.maxIndex()); }
+
+        bool isVertex(int vid) const { return _vertexRefs.isValid(vid); }
+        bool isTriangle(int tid) const { return _triangleRefs.isValid(tid); }
+        bool isEdge(int eid) const { return _edgeRefs.isValid(eid); }
+
+        // true if no ids are free, so ids are exactly [0, count)
+        bool isCompact() const { return _vertexRefs.isDense() && _triangleRefs.isDense() && _edgeRefs.isDense(); }
+
+        // number of triangles using vertex 'vid'
+        int vertexTriangleCount(int vid) const { return static_cast<int>(_vertexRefs.refCount(vid)) - 1; }
+
+        const RefCountVector& vertexRefCounts() const { return _vertexRefs; }
+        const RefCountVector& triangleRefCounts() const { return _triangleRefs; }
+
+        void reserve(std::size_t vertexCount, std::size_t triangleCount)
+        {
+            _vertexRefs.reserve(vertexCount);
+            _vertexEdges.reserve(vertexCount);
+            _positions.reserve(vertexCount);
+            if (hasVertexNormals()) _normals.reserve(vertexCount);
+            if (hasVertexColors()) _colors.reserve(vertexCount);
+            if (hasVertexUVs()) { _u.reserve(vertexCount); _v.reserve(vertexCount); }
+            _triangleRefs.reserve(triangleCount);
+            _triangles.reserve(triangleCount);
+            if (hasTriangleGroups()) _groups.reserve(triangleCount);
+            _triangleEdges.reserve(triangleCount);
+
+            // closed manifold meshes have 3/2 edges per triangle
+            auto edgeCount = triangleCount + triangleCount / 2 + 1;
+            _edgeRefs.reserve(edgeCount);
+            _edgeVertices.reserve(edgeCount);
+            _edgeTriangles.reserve(edgeCount);
+        }
+
+        void clear()
+        {
+            _vertexRefs.clear();
+            _triangleRefs.clear();
+            _edgeRefs.clear();
+            _positions.clear();
+            _normals.clear();
+            _colors.clear();
+            _u.clear();
+            _v.clear();
+            _triangles.clear();
+            _groups.clear();
+            _triangleEdges.clear();
+            _edgeVertices.clear();
+            _edgeTriangles.clear();
+            _vertexEdges.clear();
+        }
+
+        // vertices
+
+        // new vertex with default attributes, returns its id
+        int appendVertex(const vector_type &v)
+        {
+            auto vid = _vertexRefs.allocate();
+            if (vid == maxVertexID() - 1 && static_cast<std::size_t>(vid) == _positions.size())
+            {
+                _positions.append(v);
+                if (hasVertexNormals()) _normals.append(normal_type(0, 1, 0));
+                if (hasVertexColors()) _colors.append(color_type(1, 1, 1));
+                if (hasVertexUVs()) { _u.push_back(0); _v.push_back(0); }
+                _vertexEdges.resize(_positions.size());
+            }
+            else
+            {
+                _positions.set(vid, v);
+                if (hasVertexNormals()) _normals.set(vid, normal_type(0, 1, 0));
+                if (hasVertexColors()) _colors.set(vid, color_type(1, 1, 1));
+                if (hasVertexUVs()) { _u[vid] = 0; _v[vid] = 0; }
+            }
+            return vid;
+        }
+
+        int appendVertex(const vector_type &v, const normal_type &n)
+        {
+            auto vid = appendVertex(v);
+            if (hasVertexNormals()) _normals.set(vid, n);
+            return vid;
+        }
+
+        // Removes a vertex together with the triangles using it. Returns false if 'vid' is
+        // not a vertex, or if it is still used and 'removeAllTriangles' is false.
+        bool removeVertex(int vid, bool removeAllTriangles = true)
+        {
+            if (!isVertex(vid)) return false;
+            if (_vertexRefs.refCount(vid) != 1)
+            {
+                if (!removeAllTriangles) return false;
+                // every edge has a triangle, removing it drops the edge once unused
+                while (!_vertexEdges.empty(vid))
+                {
+                    auto et = _edgeTriangles[firstVertexEdge(vid)];
+                    removeTriangle(toInt(et[0]), false);
+                }
+            }
+            _vertexRefs.decrement(vid);
+            return true;
+        }
+
+        vector_type getVertex(int vid) const { return _positions.get(vid); }
+        void setVertex(int vid, const vector_type &v) { _positions.set(vid, v); }
+
+        normal_type getVertexNormal(int vid) const
+        { return hasVertexNormals() ? _normals.get(vid) : normal_type(0, 1, 0); }
+        void setVertexNormal(int vid, const normal_type &n) { _normals.set(vid, n); }
+
+        color_type getVertexColor(int vid) const
+        { return hasVertexColors() ? _colors.get(vid) : color_type(1, 1, 1); }
+        void setVertexColor(int vid, const color_type &c) { _colors.set(vid, c); }
+
+        uv_type getVertexUV(int vid) const
+        { return hasVertexUVs() ? uv_type(_u[vid], _v[vid]) : uv_type(0, 0); }
+        void setVertexUV(int vid, const uv_type &uv) { _u[vid] = uv.x(); _v[vid] = uv.y(); }
+
+        // triangles
+
+        // Returns the new triangle id, invalidID if a vertex does not exist or two corners
+        // are the same vertex, or nonManifoldID if an edge already has two triangles.
+        int appendTriangle(const index_type &tv, int group = 0)
+        {
+            int a = toInt(tv[0]), b = toInt(tv[1]), c = toInt(tv[2]);
+            if (!isVertex(a) || !isVertex(b) || !isVertex(c)) return invalidID;
+            if (a == b || b == c || c == a) return invalidID;
+
+            int e[3] = { findEdge(a, b), findEdge(b, c), findEdge(c, a) };
+            for (int j = 0; j < 3; ++j)
+                if (e[j] != invalidID && toInt(_edgeTriangles[e[j]][1]) != invalidID) return nonManifoldID;
+
+            auto tid = _triangleRefs.allocate();
+            if (static_cast<std::size_t>(tid) == _triangles.size())
+            {
+                _triangles.push_back(tv);
+                _triangleEdges.emplace_back();
+                if (hasTriangleGroups()) _groups.push_back(group);
+            }
+            else
+            {
+                _triangles[tid] = tv;
+                if (hasTriangleGroups()) _groups[tid] = group;
+            }
+            _vertexRefs.increment(a);
+            _vertexRefs.increment(b);
+            _vertexRefs.increment(c);
+
+            int v[3] = { a, b, c };
+            for (int j = 0; j < 3; ++j)
+            {
+                if (e[j] == invalidID) e[j] = addEdge(v[j], v[(j + 1) % 3], tid);
+                else _edgeTriangles[e[j]][1] = tid;
+            }
+            _triangleEdges[tid] = index_type(e[0], e[1], e[2]);
+            return tid;
+        }
+
+        int appendTriangle(int a, int b, int c, int group = 0)
+        { return appendTriangle(index_type(a, b, c), group); }
+
+        // Removes a triangle; its vertices are removed too once no triangle uses them,
+        // unless 'removeIsolatedVertices' is false.
+        bool removeTriangle(int tid, bool removeIsolatedVertices = true)
+        {
+            if (!isTriangle(tid)) return false;
+
+            auto te = _triangleEdges[tid];
+            for (int j = 0; j < 3; ++j)
+            {
+                int eid = toInt(te[j]);
+                auto &et = _edgeTriangles[eid];
+                if (toInt(et[1]) == invalidID) removeEdge(eid);
+                else
+                {
+                    // keep the remaining triangle first
+                    if (toInt(et[0]) == tid) et[0] = et[1];
+                    et[1] = Index::invalidValue;
+                }
+            }
+
+            auto tv = _triangles[tid];
+            for (int j = 0; j < 3; ++j)
+            {
+                int vid = static_cast<int>(tv[j]);
+                _vertexRefs.decrement(vid);
+                if (removeIsolatedVertices && _vertexRefs.refCount(vid) == 1) _vertexRefs.decrement(vid);
+            }
+            _triangleRefs.decrement(tid);
+            return true;
+        }
+
+        index_type getTriangle(int tid) const { return _triangles[tid]; }
+        index_type getTriangleEdges(int tid) const { return _triangleEdges[tid]; }
+
+        int getTriangleGroup(int tid) const { return hasTriangleGroups() ? _groups[tid] : 0; }
+        void setTriangleGroup(int tid, int group) { _groups[tid] = group; }
+
+        triangle_type getTriangleGeometry(int tid) const
+        {
+            const auto &tv = _triangles[tid];
+            return triangle_type(getVertex(tv[0]), getVertex(tv[1]), getVertex(tv[2]));
+        }
+
+        // unit normal of a triangle, counter-clockwise winding
+        template<typename Precision = PrecisionExact>
+        vector_type getTriangleNormal(int tid) const
+        {
+            auto tri = getTriangleGeometry(tid);
+            return (tri.v1() - tri.v0()).cross(tri.v2() - tri.v0()).template normalized<Precision>();
+        }
+
+        value_type getTriangleArea(int tid) const
+        {
+            auto tri = getTriangleGeometry(tid);
+            return (tri.v1() - tri.v0()).cross(tri.v2() - tri.v0()).length() * value_type(0.5);
+        }
+
+        // edges
+
+        // vertices of an edge, ordered [a, b] with a < b
+        Index2 getEdgeV(int eid) const { return _edgeVertices[eid]; }
+        // triangles of an edge, the second one is invalid on boundary edges
+        Index2 getEdgeT(int eid) const { return _edgeTriangles[eid]; }
+
+        bool isBoundaryEdge(int eid) const { return toInt(_edgeTriangles[eid][1]) == invalidID; }
+
+        // edge joining vertices 'a' and 'b' in either order, or invalidID
+        int findEdge(int a, int b) const
+        {
+            if (!isVertex(a) || !isVertex(b)) return invalidID;
+            // the other vertex of edge e is a ^ e0 ^ e1, so one compare per edge
+            auto key = static_cast<Index::value_type>(a) ^ static_cast<Index::value_type>(b);
+            return _vertexEdges.findFirst(a, [&](int eid)
+            {
+                const auto &ev = _edgeVertices[eid];
+                return (static_cast<Index::value_type>(ev[0]) ^ static_cast<Index::value_type>(ev[1])) == key;
+            });
+        }
+
+        // edge joining 'a' and 'b' among the edges of triangle 'tid', or invalidID
+        int findEdgeFromTriangle(int a, int b, int tid) const
+        {
+            auto j = toInt(IndexUtil::find_edge_index_in_tri(a, b, _triangles[tid]));
+            return j == invalidID ? invalidID : toInt(_triangleEdges[tid][j]);
+        }
+
+        // Vertices opposite to edge 'eid' in its two triangles, the second one is invalid
+        // on boundary edges. These are the endpoints of the edge after flipEdge().
+        Index2 getEdgeOpposingV(int eid) const
+        {
+            const auto &ev = _edgeVertices[eid];
+            const auto &et = _edgeTriangles[eid];
+            Index c = IndexUtil::find_tri_other_v(ev[0], ev[1], _triangles[toInt(et[0])]);
+            Index d = isBoundaryEdge(eid) ? Index() : IndexUtil::find_tri_other_v(ev[0], ev[1], _triangles[toInt(et[1])]);
+            return Index2(c, d);
+        }
+
+        // one-ring
+
+        // number of edges at a vertex
+        int getVertexValence(int vid) const { return _vertexEdges.count(vid); }
+
+        bool isBoundaryVertex(int vid) const
+        {
+            return _vertexEdges.findFirst(vid, [this](int eid) { return isBoundaryEdge(eid); }) != invalidID;
+        }
+
+        // calls f(eid) for every edge at vertex 'vid'
+        template<typename F>
+        void forEachVertexEdge(int vid, F f) const { _vertexEdges.forEach(vid, f); }
+
+        // calls f(nbrid) for every vertex sharing an edge with 'vid'
+        template<typename F>
+        void forEachVertexNeighbour(int vid, F f) const
+        {
+            auto v = static_cast<Index::value_type>(vid);
+            _vertexEdges.forEach(vid, [&](int eid)
+            {
+                const auto &ev = _edgeVertices[eid];
+                f(toInt(static_cast<Index::value_type>(ev[0]) ^ static_cast<Index::value_type>(ev[1]) ^ v));
+            });
+        }
+
+        // Calls f(tid) once for every triangle using vertex 'vid'. Every triangle has
+        // exactly one edge leaving 'vid' in winding order, that edge reports it.
+        template<typename F>
+        void forEachVertexTriangle(int vid, F f) const
+        {
+            auto v = static_cast<Index::value_type>(vid);
+            _vertexEdges.forEach(vid, [&](int eid)
+            {
+                const auto &ev = _edgeVertices[eid];
+                Index other(static_cast<Index::value_type>(ev[0]) ^ static_cast<Index::value_type>(ev[1]) ^ v);
+                const auto &et = _edgeTriangles[eid];
+                int t0 = toInt(et[0]), t1 = toInt(et[1]);
+                if (IndexUtil::tri_has_sequential_v(_triangles[t0], Index(vid), other)) f(t0);
+                if (t1 != invalidID && IndexUtil::tri_has_sequential_v(_triangles[t1], Index(vid), other)) f(t1);
+            });
+        }
+
+        // Replaces edge [a, b] shared by triangles [a, b, c] and [b, a, d] with edge
+        // [c, d], turning them into [c, d, b] and [d, c, a]. The edge keeps its id.
+        // Fails on boundary edges and if [c, d] already exists.
+        bool flipEdge(int eid)
+        {
+            if (!isEdge(eid) || isBoundaryEdge(eid)) return false;
+
+            const auto et = _edgeTriangles[eid];
+            int t0 = toInt(et[0]), t1 = toInt(et[1]);
+            Index a = _edgeVertices[eid][0], b = _edgeVertices[eid][1];
+            if (!IndexUtil::tri_has_sequential_v(_triangles[t0], a, b)) std::swap(a, b);
+            Index c = IndexUtil::find_tri_other_v(a, b, _triangles[t0]);
+            Index d = IndexUtil::find_tri_other_v(a, b, _triangles[t1]);
+            int ia = toInt(a), ib = toInt(b), ic = toInt(c), id = toInt(d);
+            if (ic == id || findEdge(ic, id) != invalidID) return false;
+
+            int ebc = findEdgeFromTriangle(ib, ic, t0), eca = findEdgeFromTriangle(ic, ia, t0);
+            int ead = findEdgeFromTriangle(ia, id, t1), edb = findEdgeFromTriangle(id, ib, t1);
+
+            _triangles[t0] = index_type(c, d, b);
+            _triangles[t1] = index_type(d, c, a);
+            _triangleEdges[t0] = index_type(eid, edb, ebc);
+            _triangleEdges[t1] = index_type(eid, eca, ead);
+            replaceEdgeTriangle(edb, t1, t0);
+            replaceEdgeTriangle(eca, t0, t1);
+
+            _vertexEdges.remove(ia, eid);
+            _vertexEdges.remove(ib, eid);
+            _vertexEdges.insert(ic, eid);
+            _vertexEdges.insert(id, eid);
+            _edgeVertices[eid] = ic < id ? Index2(c, d) : Index2(d, c);
+
+            _vertexRefs.decrement(ia);
+            _vertexRefs.decrement(ib);
+            _vertexRefs.increment(ic);
+            _vertexRefs.increment(id);
+            return true;
+        }
+
+        // iteration over live ids in increasing order
+        template<typename F>
+        void forEachVertex(F f) const { _vertexRefs.forEach(f); }
+
+        template<typename F>
+        void forEachTriangle(F f) const { _triangleRefs.forEach(f); }
+
+        template<typename F>
+        void forEachEdge(F f) const { _edgeRefs.forEach(f); }
+
+        box_type bounds() const
+        {
+            box_type box;
+            _vertexRefs.forEach([&](int vid) { box.contain(getVertex(vid)); });
+            return box;
+        }
+
+        // raw storage, indexed by id; entries of free ids are stale
+        const PointSet3<value_type>& positions() const { return _positions; }
+        const PointSet3<float>& normals() const { return _normals; }
+        const PointSet3<float>& colors() const { return _colors; }
+        const float* dataU() const { return _u.data(); }
+        const float* dataV() const { return _v.data(); }
+        const std::vector<index_type>& triangles() const { return _triangles; }
+        const std::vector<int>& triangleGroups() const { return _groups; }
+        const std::vector<index_type>& triangleEdges() const { return _triangleEdges; }
+        const std::vector<Index2>& edgeVertices() const { return _edgeVertices; }
+        const std::vector<Index2>& edgeTriangles() const { return _edgeTriangles; }
+
+    private:
+        // invalid Index maps to invalidID
+        static int toInt(Index i) { return static_cast<int>(static_cast<Index::value_type>(i)); }
+
+        int firstVertexEdge(int vid) const { return _vertexEdges.findFirst(vid, [](int) { return true; }); }
+
+        int addEdge(int a, int b, int tid)
+        {
+            if (b < a) std::swap(a, b);
+            auto eid = _edgeRefs.allocate();
+            if (static_cast<std::size_t>(eid) == _edgeVertices.size())
+            {
+                _edgeVertices.emplace_back(a, b);
+                _edgeTriangles.emplace_back(tid, Index::invalidValue);
+            }
+            else
+            {
+                _edgeVertices[eid] = Index2(a, b);
+                _edgeTriangles[eid] = Index2(tid, Index::invalidValue);
+            }
+            _vertexEdges.insert(a, eid);
+            _vertexEdges.insert(b, eid);
+            return eid;
+        }
+
+        void removeEdge(int eid)
+        {
+            const auto &ev = _edgeVertices[eid];
+            _vertexEdges.remove(toInt(ev[0]), eid);
+            _vertexEdges.remove(toInt(ev[1]), eid);
+            _edgeRefs.decrement(eid);
+        }
+
+        void replaceEdgeTriangle(int eid, int tOld, int tNew)
+        {
+            auto &et = _edgeTriangles[eid];
+            if (toInt(et[0]) == tOld) et[0] = tNew;
+            else et[1] = tNew;
+        }
+
+        template<typename V>
+        static void fill(PointSet3<float> &set, const V &value)
+        {
+            for (std::size_t i = 0; i < set.size(); ++i) set.set(i, value);
+        }
+
+        unsigned _components;
+        RefCountVector _vertexRefs, _triangleRefs, _edgeRefs;
+
+        PointSet3<value_type> _positions;
+        PointSet3<float> _normals, _colors;
+        std::vector<float, AlignedAllocator<float>> _u, _v;
+
+        std::vector<index_type> _triangles;
+        std::vector<int> _groups;
+
+        std::vector<index_type> _triangleEdges;
+        std::vector<Index2> _edgeVertices;
+        std::vector<Index2> _edgeTriangles;
+        SmallListSet _vertexEdges;
+    };
+
+    using DMesh3d = DMesh3<double>;
+    using DMesh3f = DMesh3<float>;
+}
+
+#endif
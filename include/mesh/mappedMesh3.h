@@ -0,0 +1,252 @@
+﻿#ifndef G3_MESH_MAPPED_MESH_3
+#define G3_MESH_MAPPED_MESH_3
+
+#include <cstddef>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <core/memoryMappedFile.h>
+#include <math/vectorTraits.h>
+#include <math/precision.h>
+#include <math/indexType.h>
+#include <math/AxisAlignedBox3.h>
+
+namespace g3
+{
+    // Read only or copy on write view of an indexed triangle mesh stored in two raw
+    // files: packed positions (three T per vertex) and packed Index3 triangles, as
+    // written by write(). Both files are memory mapped, nothing is copied and pages are
+    // only loaded when touched, so meshes larger than RAM can be processed.
+    //
+    // The chunked iteration functions walk the vertices or triangles in blocks of about
+    // chunkBytes(), asking the system to read the next block ahead while the current
+    // one is processed. With releaseChunks() set, the pages of a block are given back
+    // after it is processed (read only views only), so one pass over a large file does
+    // not push everything else out of memory.
+    //
+    // Triangle indices come straight from the file and are not checked by open(), which
+    // would have to read the whole file; the functions that follow them into the
+    // vertices check each chunk before using it and return false on a bad index.
+    template<typename T>
+    class MappedMesh3
+    {
+    public:
+        using vector_type = typename Vector3Traits<T>::vector_type;
+        using value_type  = typename vector_type::value_type;
+        using index_type  = Index3;
+        using box_type    = AxisAlignedBox3<T>;
+        using mode_type   = MemoryMappedFile::Mode;
+        using self_type   = MappedMesh3<T>;
+
+        static_assert(sizeof(vector_type) == 3 * sizeof(value_type) && std::is_trivially_copyable<vector_type>::value,
+                      "positions must be packed to be mapped");
+
+        // static values
+        static constexpr std::size_t defaultChunkBytes = std::size_t(1) << 20;
+
+        // static functions
+        // write the two files read by open()
+        static bool write(const std::string &positionsPath, const std::string &trianglesPath,
+                          const vector_type *vertices, std::size_t vertexCount,
+                          const index_type *triangles, std::size_t triangleCount)
+        {
+            return writeRaw(positionsPath, vertices, vertexCount * sizeof(vector_type)) &&
+                   writeRaw(trianglesPath, triangles, triangleCount * sizeof(index_type));
+        }
+
+        static bool write(const std::string &positionsPath, const std::string &trianglesPath,
+                          const std::vector<vector_type> &vertices, const std::vector<index_type> &triangles)
+        { return write(positionsPath, trianglesPath, vertices.data(), vertices.size(), triangles.data(), triangles.size()); }
+
+        // constructors
+        MappedMesh3() : _chunkBytes(defaultChunkBytes), _releaseChunks(false) {}
+        MappedMesh3(const std::string &positionsPath, const std::string &trianglesPath,
+                    mode_type mode = MemoryMappedFile::ReadOnly) :
+            _chunkBytes(defaultChunkBytes), _releaseChunks(false)
+        { open(positionsPath, trianglesPath, mode); }
+
+        // functions
+        // false if a file cannot be mapped or its size is not a whole number of elements
+        bool open(const std::string &positionsPath, const std::string &trianglesPath,
+                  mode_type mode = MemoryMappedFile::ReadOnly)
+        {
+            close();
+            if (!_positions.open(positionsPath, mode) || !_triangles.open(trianglesPath, mode) ||
+                _positions.size() % sizeof(vector_type) != 0 || _triangles.size() % sizeof(index_type) != 0)
+            {
+                close();
+                return false;
+            }
+            return true;
+        }
+
+        void close()
+        {
+            _positions.close();
+            _triangles.close();
+        }
+
+        bool isOpen() const { return _positions.isOpen() && _triangles.isOpen(); }
+        mode_type mode() const { return _positions.mode(); }
+
+        std::size_t vertexCount() const { return _positions.size() / sizeof(vector_type); }
+        std::size_t triangleCount() const { return _triangles.size() / sizeof(index_type); }
+
+        const vector_type* vertices() const { return reinterpret_cast<const vector_type*>(_positions.data()); }
+        const index_type* triangles() const { return reinterpret_cast<const index_type*>(_triangles.data()); }
+        // writable views of a copy on write mesh, nullptr for read only meshes
+        vector_type* writableVertices() { return reinterpret_cast<vector_type*>(_positions.writableData()); }
+        index_type* writableTriangles() { return reinterpret_cast<index_type*>(_triangles.writableData()); }
+
+        const vector_type& getVertex(std::size_t vid) const { return vertices()[vid]; }
+        const index_type& getTriangle(std::size_t tid) const { return triangles()[tid]; }
+
+        // chunk size of the iteration functions, rounded up to whole pages
+        std::size_t chunkBytes() const { return _chunkBytes; }
+        void setChunkBytes(std::size_t n)
+        {
+            auto page = MemoryMappedFile::pageSize();
+            _chunkBytes = std::max((n + page - 1) / page, std::size_t(1)) * page;
+        }
+
+        bool releaseChunks() const { return _releaseChunks; }
+        void setReleaseChunks(bool release) { _releaseChunks = release; }
+
+        // f(begin, end, chunk) for consecutive ranges of vertices, chunk[0] is vertex 'begin'
+        template<typename F>
+        void forVertexChunks(F f) const
+        { forChunks(_positions, vertices(), vertexCount(), f); }
+
+        // f(begin, end, chunk) for consecutive ranges of triangles
+        template<typename F>
+        void forTriangleChunks(F f) const
+        { forChunks(_triangles, triangles(), triangleCount(), f); }
+
+        // bounding box of all vertices in one streaming pass
+        box_type bounds() const
+        {
+            auto box = box_type::empty;
+            forVertexChunks([&box](std::size_t begin, std::size_t end, const vector_type *chunk)
+            {
+                for (std::size_t i = 0; i < end - begin; ++i) box.contain(chunk[i]);
+            });
+            return box;
+        }
+
+        // Bounds of every triangle into 'out' (triangleCount() values), the input of
+        // BVH3::build(). Streams the triangles; vertices are read where they are used.
+        // False if a triangle index is not below vertexCount(), 'out' is then incomplete.
+        bool triangleBounds(box_type *out) const
+        {
+            auto v = vertices();
+            auto n = vertexCount();
+            bool valid = true;
+            forTriangleChunks([v, n, out, &valid](std::size_t begin, std::size_t end, const index_type *chunk)
+            {
+                if (!valid || !(valid = validIndices(chunk, end - begin, n))) return;
+                for (std::size_t i = 0; i < end - begin; ++i)
+                {
+                    const auto &t = chunk[i];
+                    box_type box(v[t[0]], v[t[0]]);
+                    box.contain(v[t[1]]);
+                    box.contain(v[t[2]]);
+                    out[begin + i] = box;
+                }
+            });
+            return valid;
+        }
+
+        bool triangleBounds(std::vector<box_type> &out) const
+        {
+            out.resize(triangleCount());
+            return triangleBounds(out.data());
+        }
+
+        // Area weighted unit vertex normals into 'normals' (vertexCount() values, e.g.
+        // another mapping), in one streaming pass over the triangles and one over the
+        // normals. Vertices without triangles get the zero vector. MeshNormals is the
+        // parallel alternative when the triangles fit in memory. False if a triangle
+        // index is not below vertexCount(), 'normals' are then left unnormalized.
+        template<typename Precision = PrecisionExact>
+        bool computeNormals(vector_type *normals) const
+        {
+            std::fill(normals, normals + vertexCount(), vector_type::zero);
+            auto v = vertices();
+            auto n = vertexCount();
+            bool valid = true;
+            forTriangleChunks([v, n, normals, &valid](std::size_t begin, std::size_t end, const index_type *chunk)
+            {
+                if (!valid || !(valid = validIndices(chunk, end - begin, n))) return;
+                for (std::size_t i = 0; i < end - begin; ++i)
+                {
+                    const auto &t = chunk[i];
+                    auto p0 = v[t[0]];
+                    auto weighted = (v[t[1]] - p0).cross(v[t[2]] - p0);
+                    for (int j = 0; j < 3; ++j) normals[t[j]] = normals[t[j]] + weighted;
+                }
+            });
+            if (!valid) return false;
+            for (std::size_t i = 0; i < vertexCount(); ++i)
+                normals[i] = normals[i].template normalized<Precision>();
+            return true;
+        }
+
+        template<typename Precision = PrecisionExact>
+        bool computeNormals(std::vector<vector_type> &normals) const
+        {
+            normals.resize(vertexCount());
+            return computeNormals<Precision>(normals.data());
+        }
+
+    private:
+        static bool writeRaw(const std::string &path, const void *data, std::size_t bytes)
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file) return false;
+            file.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+            return static_cast<bool>(file);
+        }
+
+        static bool validIndices(const index_type *triangles, std::size_t count, std::size_t vertexCount)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                for (int j = 0; j < 3; ++j)
+                    if (static_cast<std::size_t>(triangles[i][j]) >= vertexCount) return false;
+            return true;
+        }
+
+        template<typename E, typename F>
+        void forChunks(const MemoryMappedFile &file, const E *data, std::size_t count, F &f) const
+        {
+            auto step = std::max(_chunkBytes / sizeof(E), std::size_t(1));
+            auto page = MemoryMappedFile::pageSize();
+            // chunks of 12 or 24 byte elements end inside a page, which release() keeps;
+            // each release starts at the page where the previous one stopped instead
+            std::size_t released = 0;
+            for (std::size_t begin = 0; begin < count; begin += step)
+            {
+                auto end = std::min(begin + step, count);
+                if (end < count)
+                    file.willNeed(end * sizeof(E), (std::min(end + step, count) - end) * sizeof(E));
+                f(begin, end, data + begin);
+                if (_releaseChunks)
+                {
+                    file.release(released, end * sizeof(E) - released);
+                    released = end * sizeof(E) / page * page;
+                }
+            }
+        }
+
+        MemoryMappedFile _positions, _triangles;
+        std::size_t _chunkBytes;
+        bool _releaseChunks;
+    };
+
+    using MappedMesh3d = MappedMesh3<double>;
+    using MappedMesh3f = MappedMesh3<float>;
+}
+
+#endif
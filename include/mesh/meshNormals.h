@@ -0,0 +1,212 @@
+﻿#ifndef G3_MESH_MESH_NORMALS
+#define G3_MESH_MESH_NORMALS
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <core/gParallel.h>
+#include <math/mathUtil.h>
+#include <math/vectorTraits.h>
+#include <math/precision.h>
+#include <math/indexType.h>
+
+namespace g3
+{
+    // Per vertex normals and areas of an indexed triangle mesh whose positions change
+    // far more often than its connectivity, e.g. after every step of a deformation.
+    // build() copies the triangles and inverts them once into a vertex -> corner table
+    // in CSR form: the corners (3 * tid + j) of vertex v are corners[offsets[v]] up to
+    // corners[offsets[v + 1]], in ascending order. compute() then runs two parallel
+    // passes, per triangle values into per triangle arrays and a gather of those at
+    // every vertex. Each thread only writes its own elements, so there are no atomics,
+    // and every vertex sums its corners in the same order for any thread count, so the
+    // results do not depend on it.
+    template<typename T>
+    class MeshNormals
+    {
+    public:
+        using vector_type = typename Vector3Traits<T>::vector_type;
+        using value_type  = typename vector_type::value_type;
+        using index_type  = Index3;
+        using self_type   = MeshNormals<T>;
+
+        // how the triangle normals meeting at a vertex are weighted
+        enum Weighting
+        {
+            AreaWeighted,   // by the triangle area
+            AngleWeighted   // by the interior angle of the triangle at the vertex
+        };
+
+        // constructors
+        MeshNormals() : _vertexCount(0), _threadCount(0) {}
+        MeshNormals(const std::vector<index_type> &triangles, std::size_t vertexCount) :
+            _vertexCount(0), _threadCount(0)
+        { build(triangles, vertexCount); }
+
+        // functions
+        int threadCount() const { return _threadCount; }
+        void setThreadCount(int n) { _threadCount = n; }
+
+        std::size_t vertexCount() const { return _vertexCount; }
+        std::size_t triangleCount() const { return _triangles.size(); }
+
+        // corners of vertex 'vid' as [begin, end) into the corner table
+        std::size_t cornerBegin(std::size_t vid) const { return _offsets[vid]; }
+        std::size_t cornerEnd(std::size_t vid) const { return _offsets[vid + 1]; }
+        std::uint32_t corner(std::size_t i) const { return _corners[i]; }
+
+        // Every index of 'triangles' must be below 'vertexCount'. Serial counting sort,
+        // linear in the triangle count; rebuild only when the connectivity changes.
+        void build(const index_type *triangles, std::size_t count, std::size_t vertexCount)
+        {
+            _triangles.assign(triangles, triangles + count);
+            _vertexCount = vertexCount;
+            _offsets.assign(vertexCount + 1, 0);
+            for (std::size_t i = 0; i < count; ++i)
+                for (int j = 0; j < 3; ++j)
+                    ++_offsets[triangles[i][j] + 1];
+            for (std::size_t v = 0; v < vertexCount; ++v)
+                _offsets[v + 1] += _offsets[v];
+
+            _corners.resize(3 * count);
+            std::vector<std::uint32_t> next(_offsets.begin(), _offsets.end() - 1);
+            for (std::size_t i = 0; i < count; ++i)
+                for (int j = 0; j < 3; ++j)
+                    _corners[next[triangles[i][j]]++] = static_cast<std::uint32_t>(3 * i + j);
+        }
+
+        void build(const std::vector<index_type> &triangles, std::size_t vertexCount)
+        { build(triangles.data(), triangles.size(), vertexCount); }
+
+        // Unit normal of every vertex into 'normals', which must hold vertexCount()
+        // values. Counter-clockwise winding; vertices without triangles, or whose
+        // weighted sum is degenerate, get the zero vector.
+        template<typename Precision = PrecisionExact>
+        void compute(const vector_type *positions, vector_type *normals, Weighting weighting = AreaWeighted)
+        {
+            auto threads = gParallel::resolveThreadCount(_threadCount);
+            auto triCount = _triangles.size();
+            auto angles = (weighting == AngleWeighted);
+            _faceNormals.resize(triCount);
+            if (angles) _cornerWeights.resize(3 * triCount);
+
+            // pass 1: cross product of every triangle, its length is twice the area;
+            // angle weighting stores the unit normal and the three corner angles
+            gParallel::forBlocks(0, triCount, blockCount(triCount, threads),
+                [&](int, std::size_t b, std::size_t e)
+            {
+                for (auto i = b; i < e; ++i)
+                {
+                    const auto &t = _triangles[i];
+                    auto p0 = positions[t[0]], p1 = positions[t[1]], p2 = positions[t[2]];
+                    auto e0 = p1 - p0, e1 = p2 - p1, e2 = p0 - p2;
+                    auto n = e0.cross(e1);
+                    if (!angles)
+                    {
+                        _faceNormals[i] = n;
+                        continue;
+                    }
+                    // the angle between two edges of a triangle is atan2(|e x f|, e . f),
+                    // and |e x f| is the same for all three corners
+                    value_type len;
+                    auto inv = Precision::invLength(n.lengthSquared(), mathUtil::getZeroTolerance<value_type>(), len);
+                    _faceNormals[i] = n * inv;
+                    _cornerWeights[3 * i]     = std::atan2(len, -e0.dot(e2));
+                    _cornerWeights[3 * i + 1] = std::atan2(len, -e1.dot(e0));
+                    _cornerWeights[3 * i + 2] = std::atan2(len, -e2.dot(e1));
+                }
+            });
+
+            // pass 2: every vertex sums the values of its own corners
+            gParallel::forBlocks(0, _vertexCount, blockCount(_vertexCount, threads),
+                [&](int, std::size_t b, std::size_t e)
+            {
+                for (auto v = b; v < e; ++v)
+                {
+                    value_type sx = 0, sy = 0, sz = 0;
+                    for (auto k = _offsets[v]; k < _offsets[v + 1]; ++k)
+                    {
+                        auto c = _corners[k];
+                        const auto &n = _faceNormals[c / 3];
+                        auto w = angles ? _cornerWeights[c] : value_type(1);
+                        sx += w * n[0];
+                        sy += w * n[1];
+                        sz += w * n[2];
+                    }
+                    normals[v] = vector_type(sx, sy, sz).template normalized<Precision>();
+                }
+            });
+        }
+
+        template<typename Precision = PrecisionExact>
+        void compute(const std::vector<vector_type> &positions, std::vector<vector_type> &normals,
+                     Weighting weighting = AreaWeighted)
+        {
+            normals.resize(_vertexCount);
+            compute<Precision>(positions.data(), normals.data(), weighting);
+        }
+
+        // Area of every triangle, kept in triangleAreas(), and the barycentric area of
+        // every vertex (a third of the area of its triangles) into 'areas', which must
+        // hold vertexCount() values.
+        void computeAreas(const vector_type *positions, value_type *areas)
+        {
+            auto threads = gParallel::resolveThreadCount(_threadCount);
+            auto triCount = _triangles.size();
+            _triangleAreas.resize(triCount);
+
+            gParallel::forBlocks(0, triCount, blockCount(triCount, threads),
+                [&](int, std::size_t b, std::size_t e)
+            {
+                for (auto i = b; i < e; ++i)
+                {
+                    const auto &t = _triangles[i];
+                    auto p0 = positions[t[0]];
+                    _triangleAreas[i] = (positions[t[1]] - p0).cross(positions[t[2]] - p0).length() * value_type(0.5);
+                }
+            });
+
+            gParallel::forBlocks(0, _vertexCount, blockCount(_vertexCount, threads),
+                [&](int, std::size_t b, std::size_t e)
+            {
+                for (auto v = b; v < e; ++v)
+                {
+                    value_type s = 0;
+                    for (auto k = _offsets[v]; k < _offsets[v + 1]; ++k)
+                        s += _triangleAreas[_corners[k] / 3];
+                    areas[v] = s * value_type(1.0 / 3.0);
+                }
+            });
+        }
+
+        void computeAreas(const std::vector<vector_type> &positions, std::vector<value_type> &areas)
+        {
+            areas.resize(_vertexCount);
+            computeAreas(positions.data(), areas.data());
+        }
+
+        // triangle areas of the last computeAreas()
+        const std::vector<value_type>& triangleAreas() const { return _triangleAreas; }
+
+    protected:
+        // ranges smaller than this run on the calling thread only
+        static const std::size_t parallelSize = 1 << 14;
+
+        static int blockCount(std::size_t count, int threads)
+        { return (count >= parallelSize) ? threads : 1; }
+
+        std::vector<index_type> _triangles;
+        std::size_t _vertexCount;
+        std::vector<std::uint32_t> _offsets, _corners;
+        std::vector<vector_type> _faceNormals;
+        std::vector<value_type> _cornerWeights, _triangleAreas;
+        int _threadCount;
+    };
+
+    using MeshNormalsd = MeshNormals<double>;
+    using MeshNormalsf = MeshNormals<float>;
+}
+
+#endif
@@ -0,0 +1,108 @@
+﻿#ifndef G3_MESH_REF_COUNT_VECTOR
+#define G3_MESH_REF_COUNT_VECTOR
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace g3
+{
+    // Reference counts of a dense id space with a free list, after g3Sharp RefCountVector.
+    // Ids are allocated with a count of 1; an id whose count drops to 0 is free and
+    // is handed out again by the next allocate(). Storage is one 32 bit count per id.
+    class RefCountVector
+    {
+    public:
+        using count_type = std::uint32_t;
+        using self_type  = RefCountVector;
+
+        // constructors
+        RefCountVector() : _used(0) {}
+
+        // functions
+        // number of live ids
+        std::size_t count() const { return _used; }
+        // size of the id space, live ids are in [0, maxIndex())
+        std::size_t maxIndex() const { return _counts.size(); }
+        bool empty() const { return _used == 0; }
+        // no free ids below maxIndex(); the free list may still hold ids that were
+        // allocated again through allocateAt(), so it is not checked
+        bool isDense() const { return _used == _counts.size(); }
+
+        bool isValid(int i) const
+        { return i >= 0 && static_cast<std::size_t>(i) < _counts.size() && _counts[i] != 0; }
+
+        count_type refCount(int i) const { return _counts[i]; }
+
+        int allocate()
+        {
+            while (!_free.empty())
+            {
+                auto i = _free.back();
+                _free.pop_back();
+                // an id can be freed, reused through allocateAt() and freed again
+                if (_counts[i] != 0) continue;
+                _counts[i] = 1;
+                ++_used;
+                return i;
+            }
+            _counts.push_back(1);
+            ++_used;
+            return static_cast<int>(_counts.size() - 1);
+        }
+
+        // allocates id 'i' if it is free, growing the id space as needed; false if it is live
+        bool allocateAt(int i)
+        {
+            auto n = static_cast<std::size_t>(i);
+            if (n >= _counts.size())
+            {
+                for (auto j = _counts.size(); j < n; ++j) _free.push_back(static_cast<int>(j));
+                _counts.resize(n + 1, 0);
+            }
+            else if (_counts[n] != 0) return false;
+            _counts[n] = 1;
+            ++_used;
+            return true;
+        }
+
+        void increment(int i, count_type n = 1) { _counts[i] += n; }
+
+        void decrement(int i, count_type n = 1)
+        {
+            _counts[i] -= n;
+            if (_counts[i] == 0)
+            {
+                _free.push_back(i);
+                --_used;
+            }
+        }
+
+        void reserve(std::size_t count) { _counts.reserve(count); }
+
+        void clear()
+        {
+            _counts.clear();
+            _free.clear();
+            _used = 0;
+        }
+
+        // calls f(i) for every live id in increasing order
+        template<typename F>
+        void forEach(F f) const
+        {
+            auto n = _counts.size();
+            for (std::size_t i = 0; i < n; ++i)
+                if (_counts[i] != 0) f(static_cast<int>(i));
+        }
+
+        const std::vector<count_type>& rawCounts() const { return _counts; }
+
+    private:
+        std::vector<count_type> _counts;
+        std::vector<int> _free;
+        std::size_t _used;
+    };
+}
+
+#endif
@@ -0,0 +1,217 @@
+﻿#ifndef G3_MESH_SMALL_LIST_SET
+#define G3_MESH_SMALL_LIST_SET
+
+#include <cstddef>
+#include <vector>
+
+namespace g3
+{
+    // Pool of many small unordered int lists, after g3Sharp SmallListSet.
+    // The first blockSize values of a list live in a fixed block of one shared
+    // array; further values go to a shared linked pool. Blocks and links of freed
+    // lists are recycled, so inserts and removes allocate only when a pool grows
+    // and iteration never allocates. Used for the vertex -> edge lists of DMesh3.
+    class SmallListSet
+    {
+    public:
+        using self_type = SmallListSet;
+
+        // static values
+        static constexpr int blockSize = 8;
+        static constexpr int invalidID = -1;
+
+        // constructors
+        SmallListSet() : _freeLinked(invalidID) {}
+
+        // functions
+        // number of lists
+        std::size_t size() const { return _heads.size(); }
+
+        // grows or shrinks to 'count' lists, new lists are empty
+        void resize(std::size_t count)
+        {
+            for (auto i = count; i < _heads.size(); ++i) clear(static_cast<int>(i));
+            _heads.resize(count, invalidID);
+        }
+
+        void reserve(std::size_t count) { _heads.reserve(count); _blocks.reserve(count * blockStride); }
+
+        void clear()
+        {
+            _heads.clear();
+            _blocks.clear();
+            _freeBlocks.clear();
+            _linked.clear();
+            _freeLinked = invalidID;
+        }
+
+        int count(int list) const
+        {
+            auto b = _heads[list];
+            return b == invalidID ? 0 : _blocks[b];
+        }
+
+        bool empty(int list) const { return _heads[list] == invalidID; }
+
+        void insert(int list, int value)
+        {
+            auto b = _heads[list];
+            if (b == invalidID)
+            {
+                b = allocateBlock();
+                _heads[list] = b;
+            }
+            auto n = _blocks[b];
+            if (n < blockSize) _blocks[b + 2 + n] = value;
+            else
+            {
+                auto l = allocateLinked();
+                _linked[l] = value;
+                _linked[l + 1] = _blocks[b + 1];
+                _blocks[b + 1] = l;
+            }
+            _blocks[b] = n + 1;
+        }
+
+        // removes one occurrence of 'value', order of the remaining values may change
+        bool remove(int list, int value)
+        {
+            auto b = _heads[list];
+            if (b == invalidID) return false;
+
+            auto n = _blocks[b];
+            auto m = n < blockSize ? n : blockSize;
+            for (int i = 0; i < m; ++i)
+            {
+                if (_blocks[b + 2 + i] != value) continue;
+                auto l = _blocks[b + 1];
+                if (l != invalidID)
+                {
+                    // refill the block slot from the overflow head
+                    _blocks[b + 2 + i] = _linked[l];
+                    _blocks[b + 1] = _linked[l + 1];
+                    freeLinked(l);
+                }
+                else _blocks[b + 2 + i] = _blocks[b + 2 + m - 1];
+                shrink(list, b, n);
+                return true;
+            }
+
+            for (int prev = invalidID, l = _blocks[b + 1]; l != invalidID; prev = l, l = _linked[l + 1])
+            {
+                if (_linked[l] != value) continue;
+                if (prev == invalidID) _blocks[b + 1] = _linked[l + 1];
+                else _linked[prev + 1] = _linked[l + 1];
+                freeLinked(l);
+                shrink(list, b, n);
+                return true;
+            }
+            return false;
+        }
+
+        // empties a list and recycles its storage
+        void clear(int list)
+        {
+            auto b = _heads[list];
+            if (b == invalidID) return;
+            for (auto l = _blocks[b + 1]; l != invalidID;)
+            {
+                auto next = _linked[l + 1];
+                freeLinked(l);
+                l = next;
+            }
+            _freeBlocks.push_back(b);
+            _heads[list] = invalidID;
+        }
+
+        bool contains(int list, int value) const
+        { return findFirst(list, [value](int v) { return v == value; }) != invalidID; }
+
+        // first value of the list for which pred(value) is true, or invalidID
+        template<typename Pred>
+        int findFirst(int list, Pred pred) const
+        {
+            auto b = _heads[list];
+            if (b == invalidID) return invalidID;
+            auto n = _blocks[b];
+            auto m = n < blockSize ? n : blockSize;
+            for (int i = 0; i < m; ++i)
+                if (pred(_blocks[b + 2 + i])) return _blocks[b + 2 + i];
+            for (auto l = _blocks[b + 1]; l != invalidID; l = _linked[l + 1])
+                if (pred(_linked[l])) return _linked[l];
+            return invalidID;
+        }
+
+        // calls f(value) for every value of the list
+        template<typename F>
+        void forEach(int list, F f) const
+        {
+            auto b = _heads[list];
+            if (b == invalidID) return;
+            auto n = _blocks[b];
+            auto m = n < blockSize ? n : blockSize;
+            for (int i = 0; i < m; ++i) f(_blocks[b + 2 + i]);
+            for (auto l = _blocks[b + 1]; l != invalidID; l = _linked[l + 1]) f(_linked[l]);
+        }
+
+    private:
+        // block layout: count, overflow head, blockSize values
+        static constexpr int blockStride = blockSize + 2;
+
+        int allocateBlock()
+        {
+            int b;
+            if (!_freeBlocks.empty())
+            {
+                b = _freeBlocks.back();
+                _freeBlocks.pop_back();
+            }
+            else
+            {
+                b = static_cast<int>(_blocks.size());
+                _blocks.resize(_blocks.size() + blockStride);
+            }
+            _blocks[b] = 0;
+            _blocks[b + 1] = invalidID;
+            return b;
+        }
+
+        // link layout: value, next
+        int allocateLinked()
+        {
+            if (_freeLinked == invalidID)
+            {
+                auto l = static_cast<int>(_linked.size());
+                _linked.resize(_linked.size() + 2);
+                return l;
+            }
+            auto l = _freeLinked;
+            _freeLinked = _linked[l + 1];
+            return l;
+        }
+
+        void freeLinked(int l)
+        {
+            _linked[l + 1] = _freeLinked;
+            _freeLinked = l;
+        }
+
+        void shrink(int list, int b, int n)
+        {
+            if (n == 1)
+            {
+                _freeBlocks.push_back(b);
+                _heads[list] = invalidID;
+            }
+            else _blocks[b] = n - 1;
+        }
+
+        std::vector<int> _heads;
+        std::vector<int> _blocks;
+        std::vector<int> _freeBlocks;
+        std::vector<int> _linked;
+        int _freeLinked;
+    };
+}
+
+#endif
@@ -0,0 +1,657 @@
+﻿#ifndef G3_SPATIAL_BVH_3
+#define G3_SPATIAL_BVH_3
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <core/alignedAllocator.h>
+#include <core/gParallel.h>
+#include <math/AxisAlignedBox3.h>
+
+namespace g3
+{
+    // Node of a flattened bounding volume hierarchy. The two children of an inner
+    // node are stored next to each other, so a single index addresses both of them.
+    // A node takes 32 bytes for float and 64 bytes for double.
+    template<typename T>
+    struct alignas(8 * sizeof(T)) BVHNode3
+    {
+        T boxMin[3];
+        T boxMax[3];
+        std::uint32_t index;   // leaf: first entry in primitive order, inner: first child
+        std::uint32_t count;   // leaf: number of primitives, inner: 0
+
+        bool isLeaf() const { return count != 0; }
+    };
+
+    static_assert(sizeof(BVHNode3<float>) == 32, "BVHNode3<float> is expected to fill 32 bytes");
+    static_assert(sizeof(BVHNode3<double>) == 64, "BVHNode3<double> is expected to fill 64 bytes");
+
+    // Bounding volume hierarchy over an array of primitive bounds, built top-down
+    // with a binned surface area heuristic. Nodes live in one flat aligned array
+    // in depth-first order; the primitives of a leaf are the contiguous range
+    // [index, index + count) of primitiveOrder().
+    template<typename T>
+    class BVH3
+    {
+    public:
+        using vector_type = typename Vector3Traits<T>::vector_type;
+        using value_type  = typename vector_type::value_type;
+        using box_type    = AxisAlignedBox3<T>;
+        using node_type   = BVHNode3<value_type>;
+        using node_array  = std::vector<node_type, AlignedAllocator<node_type, alignof(node_type)>>;
+        using self_type   = BVH3<T>;
+
+        // static values
+        static const int binCount = 16;
+        static const int maxDepth = 64;   // below this depth nodes are split at the object median
+        static const int stackSize = 2 * maxDepth;
+
+        // static functions
+        static value_type distanceSquared(const node_type &node, const vector_type &p)
+        {
+            value_type d = 0;
+            for (int k = 0; k < 3; ++k)
+            {
+                auto v = p[k];
+                auto dk = (v < node.boxMin[k]) ? node.boxMin[k] - v : (v > node.boxMax[k]) ? v - node.boxMax[k] : 0;
+                d += dk * dk;
+            }
+            return d;
+        }
+
+        static bool overlaps(const node_type &node, const vector_type &boxMin, const vector_type &boxMax)
+        {
+            return node.boxMin[0] <= boxMax.x() && node.boxMax[0] >= boxMin.x() &&
+                   node.boxMin[1] <= boxMax.y() && node.boxMax[1] >= boxMin.y() &&
+                   node.boxMin[2] <= boxMax.z() && node.boxMax[2] >= boxMin.z();
+        }
+
+        // slab test of a ray given by origin and reciprocal direction against the node box,
+        // limited to the ray interval [0, tMax]; 'tNear' receives the entry parameter
+        static bool intersectRay(const node_type &node, const value_type origin[3], const value_type invDir[3],
+                                 value_type tMax, value_type &tNear)
+        {
+            value_type t0 = 0, t1 = tMax;
+            for (int k = 0; k < 3; ++k)
+            {
+                auto tA = (node.boxMin[k] - origin[k]) * invDir[k];
+                auto tB = (node.boxMax[k] - origin[k]) * invDir[k];
+                t0 = std::max(t0, std::min(tA, tB));
+                t1 = std::min(t1, std::max(tA, tB));
+            }
+            tNear = t0;
+            return t0 <= t1;
+        }
+
+        // constructors
+        BVH3() : _maxLeafSize(4), _threadCount(0) {}
+
+        // functions
+        int maxLeafSize() const { return _maxLeafSize; }
+        void setMaxLeafSize(int n) { _maxLeafSize = std::max(n, 1); }
+
+        // number of threads used by the builders, <= 0 means all hardware threads.
+        // The built tree is the same for every thread count.
+        int threadCount() const { return _threadCount; }
+        void setThreadCount(int n) { _threadCount = n; }
+
+        void build(const box_type *bounds, std::size_t count)
+        {
+            auto threads = gParallel::resolveThreadCount(_threadCount);
+            BuildData data;
+            initialize(bounds, count, data, threads);
+            if (count == 0) return;
+
+            _nodes.emplace_back();
+            buildNode(data, _nodes, 0, 0, static_cast<std::uint32_t>(count), 0, threads);
+        }
+
+        void build(const std::vector<box_type> &bounds)
+        { build(bounds.data(), bounds.size()); }
+
+        // Linear BVH: primitives are sorted along a 30-bit Morton curve of their centroids
+        // and nodes are split at the highest differing code bit. Much faster to build than
+        // build(), at the price of a tree that is slower to query.
+        void buildMorton(const box_type *bounds, std::size_t count)
+        {
+            auto threads = gParallel::resolveThreadCount(_threadCount);
+            BuildData data;
+            initialize(bounds, count, data, threads);
+            if (count == 0) return;
+
+            node_type all;
+            value_type cMin[3], cMax[3];
+            computeBounds(data, all, 0, static_cast<std::uint32_t>(count), cMin, cMax, threads);
+
+            // sorting (code << 32 | index) gives a unique order whatever the thread count
+            value_type scale[3];
+            for (int k = 0; k < 3; ++k)
+                scale[k] = (cMax[k] > cMin[k]) ? value_type(1023) / (cMax[k] - cMin[k]) : value_type(0);
+            std::vector<std::uint64_t> keys(count);
+            gParallel::forBlocks(0, count, threads, [&](int, std::size_t b, std::size_t e)
+            {
+                for (auto i = b; i < e; ++i)
+                {
+                    std::uint32_t code = 0;
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        auto q = static_cast<std::uint32_t>((data.centroid[3 * i + k] - cMin[k]) * scale[k]);
+                        code |= expandBits(std::min(q, std::uint32_t(1023))) << (2 - k);
+                    }
+                    keys[i] = (static_cast<std::uint64_t>(code) << 32) | i;
+                }
+            });
+            sortKeys(keys, threads);
+
+            std::vector<std::uint32_t> codes(count);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                _order[i] = static_cast<std::uint32_t>(keys[i]);
+                codes[i] = static_cast<std::uint32_t>(keys[i] >> 32);
+            }
+
+            _nodes.emplace_back();
+            buildMortonNode(data, codes, _nodes, 0, 0, static_cast<std::uint32_t>(count), threads);
+        }
+
+        void buildMorton(const std::vector<box_type> &bounds)
+        { buildMorton(bounds.data(), bounds.size()); }
+
+        bool empty() const { return _nodes.empty(); }
+        std::size_t nodeCount() const { return _nodes.size(); }
+
+        const node_type* nodes() const { return _nodes.data(); }
+        const node_type& node(std::size_t i) const { return _nodes[i]; }
+
+        // primitiveOrder()[i] is the input index of the i-th primitive in leaf order
+        const std::vector<std::uint32_t>& primitiveOrder() const { return _order; }
+
+        box_type bounds() const
+        {
+            if (_nodes.empty()) return box_type::empty;
+            const auto &root = _nodes[0];
+            return box_type(root.boxMin[0], root.boxMin[1], root.boxMin[2],
+                            root.boxMax[0], root.boxMax[1], root.boxMax[2]);
+        }
+
+        // Depth first traversal. 'nodeTest(node)' decides whether a subtree is entered,
+        // 'leafFunc(begin, end)' is called with the primitive order range of every entered
+        // leaf and returns false to stop the traversal.
+        template<typename NodeTest, typename LeafFunc>
+        void traverse(NodeTest nodeTest, LeafFunc leafFunc) const
+        {
+            if (_nodes.empty()) return;
+
+            std::uint32_t stack[stackSize];
+            int top = 0;
+            stack[top++] = 0;
+            while (top > 0)
+            {
+                const auto &node = _nodes[stack[--top]];
+                if (!nodeTest(node)) continue;
+                if (node.isLeaf())
+                {
+                    if (!leafFunc(node.index, node.index + node.count)) return;
+                }
+                else
+                {
+                    stack[top++] = node.index + 1;
+                    stack[top++] = node.index;
+                }
+            }
+        }
+
+    protected:
+        // ranges at least this large are bounded, binned and partitioned by all threads
+        static const std::uint32_t parallelBinSize = 1 << 16;
+        // subtrees at least this large are forked to a thread of their own
+        static const std::uint32_t parallelForkSize = 1 << 12;
+
+        // per primitive bounds and centroids, three values per primitive
+        struct BuildData
+        {
+            std::vector<value_type> boxMin, boxMax, centroid;
+        };
+
+        struct Bin
+        {
+            value_type boxMin[3], boxMax[3];
+            std::uint32_t count;
+        };
+
+        // the bins of one block of primitives, per axis
+        struct BinSet
+        {
+            Bin bins[3][binCount];
+        };
+
+        static value_type halfArea(const value_type boxMin[3], const value_type boxMax[3])
+        {
+            auto dx = boxMax[0] - boxMin[0], dy = boxMax[1] - boxMin[1], dz = boxMax[2] - boxMin[2];
+            return dx * dy + dy * dz + dz * dx;
+        }
+
+        static void resetBox(value_type boxMin[3], value_type boxMax[3])
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                boxMin[k] = std::numeric_limits<value_type>::max();
+                boxMax[k] = std::numeric_limits<value_type>::lowest();
+            }
+        }
+
+        static void growBox(value_type boxMin[3], value_type boxMax[3], const value_type *pMin, const value_type *pMax)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                boxMin[k] = std::min(boxMin[k], pMin[k]);
+                boxMax[k] = std::max(boxMax[k], pMax[k]);
+            }
+        }
+
+        static void resetBins(Bin bins[3][binCount])
+        {
+            for (int axis = 0; axis < 3; ++axis)
+                for (int b = 0; b < binCount; ++b)
+                {
+                    resetBox(bins[axis][b].boxMin, bins[axis][b].boxMax);
+                    bins[axis][b].count = 0;
+                }
+        }
+
+        static int binIndex(value_type c, value_type axisMin, value_type scale)
+        {
+            auto b = static_cast<int>((c - axisMin) * scale);
+            return (b < 0) ? 0 : (b >= binCount) ? binCount - 1 : b;
+        }
+
+        // spread the lower 10 bits of v to every third bit
+        static std::uint32_t expandBits(std::uint32_t v)
+        {
+            v = (v * 0x00010001u) & 0xFF0000FFu;
+            v = (v * 0x00000101u) & 0x0F00F00Fu;
+            v = (v * 0x00000011u) & 0xC30C30C3u;
+            v = (v * 0x00000005u) & 0x49249249u;
+            return v;
+        }
+
+        void initialize(const box_type *bounds, std::size_t count, BuildData &data, int threads)
+        {
+            _nodes.clear();
+            _order.resize(count);
+            data.boxMin.resize(3 * count);
+            data.boxMax.resize(3 * count);
+            data.centroid.resize(3 * count);
+            gParallel::forBlocks(0, count, (count >= parallelBinSize) ? threads : 1,
+                [&](int, std::size_t b, std::size_t e)
+            {
+                for (auto i = b; i < e; ++i)
+                {
+                    auto bmin = bounds[i].minCoordinate(), bmax = bounds[i].maxCoordinate();
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        data.boxMin[3 * i + k] = bmin[k];
+                        data.boxMax[3 * i + k] = bmax[k];
+                        data.centroid[3 * i + k] = (bmin[k] + bmax[k]) * value_type(0.5);
+                    }
+                    _order[i] = static_cast<std::uint32_t>(i);
+                }
+            });
+        }
+
+        void makeLeaf(node_type &node, std::uint32_t begin, std::uint32_t end)
+        {
+            node.index = begin;
+            node.count = end - begin;
+        }
+
+        // Copy a subtree that was built on its own into 'nodes'. sub[0] replaces nodes[rootIndex],
+        // the other nodes are appended; this is exactly where the depth-first recursion of a
+        // serial build would have put them.
+        static void appendSubtree(node_array &nodes, std::uint32_t rootIndex, const node_array &sub)
+        {
+            auto offset = static_cast<std::uint32_t>(nodes.size()) - 1;
+            nodes[rootIndex] = sub[0];
+            if (!sub[0].isLeaf()) nodes[rootIndex].index += offset;
+            for (std::size_t j = 1; j < sub.size(); ++j)
+            {
+                nodes.push_back(sub[j]);
+                if (!sub[j].isLeaf()) nodes.back().index += offset;
+            }
+        }
+
+        // build the child pair at 'left' over [begin, mid) and [mid, end) with buildFunc,
+        // forking large subtrees into local arrays that are spliced back in serial order
+        template<typename BuildFunc>
+        void buildChildren(node_array &nodes, std::uint32_t left, std::uint32_t begin, std::uint32_t mid,
+                           std::uint32_t end, int threads, BuildFunc buildFunc)
+        {
+            if (threads > 1 && end - begin >= parallelForkSize)
+            {
+                auto leftThreads = static_cast<int>((static_cast<std::uint64_t>(threads) * (mid - begin)) / (end - begin));
+                leftThreads = std::min(std::max(leftThreads, 1), threads - 1);
+                node_array leftNodes(1), rightNodes(1);
+                gParallel::invoke(
+                    [&]() { buildFunc(leftNodes, 0, begin, mid, leftThreads); },
+                    [&]() { buildFunc(rightNodes, 0, mid, end, threads - leftThreads); });
+                appendSubtree(nodes, left, leftNodes);
+                appendSubtree(nodes, left + 1, rightNodes);
+            }
+            else
+            {
+                buildFunc(nodes, left, begin, mid, 1);
+                buildFunc(nodes, left + 1, mid, end, 1);
+            }
+        }
+
+        // bounds of the primitives and of their centroids over primitive order [begin, end)
+        void computeBounds(const BuildData &data, node_type &node, std::uint32_t begin, std::uint32_t end,
+                           value_type cMin[3], value_type cMax[3], int threads)
+        {
+            auto blocks = (end - begin >= parallelBinSize) ? threads : 1;
+            std::vector<value_type> partial(12 * blocks);
+            gParallel::forBlocks(begin, end, blocks, [&](int block, std::size_t b, std::size_t e)
+            {
+                auto *box = &partial[12 * block];
+                resetBox(box, box + 3);
+                resetBox(box + 6, box + 9);
+                for (auto i = b; i < e; ++i)
+                {
+                    auto p = _order[i];
+                    growBox(box, box + 3, &data.boxMin[3 * p], &data.boxMax[3 * p]);
+                    growBox(box + 6, box + 9, &data.centroid[3 * p], &data.centroid[3 * p]);
+                }
+            });
+
+            resetBox(node.boxMin, node.boxMax);
+            resetBox(cMin, cMax);
+            for (int block = 0; block < blocks; ++block)
+            {
+                const auto *box = &partial[12 * block];
+                growBox(node.boxMin, node.boxMax, box, box + 3);
+                growBox(cMin, cMax, box + 6, box + 9);
+            }
+        }
+
+        // stable partition of primitive order [begin, end), so that every thread count yields
+        // the same order; returns the partition point
+        template<typename Pred>
+        std::uint32_t partition(std::uint32_t begin, std::uint32_t end, Pred pred, int threads)
+        {
+            auto first = _order.begin() + begin, last = _order.begin() + end;
+            if (threads <= 1 || end - begin < parallelBinSize)
+                return begin + static_cast<std::uint32_t>(std::stable_partition(first, last, pred) - first);
+
+            std::vector<std::size_t> blockBegin(threads), blockEnd(threads), leftCount(threads, 0);
+            gParallel::forBlocks(begin, end, threads, [&](int block, std::size_t b, std::size_t e)
+            {
+                blockBegin[block] = b;
+                blockEnd[block] = e;
+                std::size_t count = 0;
+                for (auto i = b; i < e; ++i) if (pred(_order[i])) ++count;
+                leftCount[block] = count;
+            });
+
+            std::size_t totalLeft = 0;
+            for (auto c : leftCount) totalLeft += c;
+            std::vector<std::size_t> leftOffset(threads), rightOffset(threads);
+            std::size_t l = 0, r = totalLeft;
+            for (int block = 0; block < threads; ++block)
+            {
+                leftOffset[block] = l;
+                rightOffset[block] = r;
+                l += leftCount[block];
+                if (blockEnd[block] > blockBegin[block]) r += (blockEnd[block] - blockBegin[block]) - leftCount[block];
+            }
+
+            std::vector<std::uint32_t> sorted(end - begin);
+            gParallel::forBlocks(begin, end, threads, [&](int block, std::size_t b, std::size_t e)
+            {
+                auto li = leftOffset[block], ri = rightOffset[block];
+                for (auto i = b; i < e; ++i)
+                {
+                    auto p = _order[i];
+                    if (pred(p)) sorted[li++] = p;
+                    else sorted[ri++] = p;
+                }
+            });
+            std::copy(sorted.begin(), sorted.end(), first);
+            return begin + static_cast<std::uint32_t>(totalLeft);
+        }
+
+        // computes the bounds of node 'nodeIndex' over primitive order [begin, end), then
+        // either turns it into a leaf or appends its child pair to 'nodes' and recurses
+        void buildNode(const BuildData &data, node_array &nodes, std::uint32_t nodeIndex,
+                       std::uint32_t begin, std::uint32_t end, int depth, int threads)
+        {
+            value_type cMin[3], cMax[3];
+            computeBounds(data, nodes[nodeIndex], begin, end, cMin, cMax, threads);
+
+            auto n = end - begin;
+            if (n <= 1)
+            {
+                makeLeaf(nodes[nodeIndex], begin, end);
+                return;
+            }
+
+            std::uint32_t mid;
+            if (depth < maxDepth) mid = splitSAH(data, nodes[nodeIndex], cMin, cMax, begin, end, threads);
+            else mid = (n <= static_cast<std::uint32_t>(_maxLeafSize)) ? end : begin;
+            if (mid == end)
+            {
+                makeLeaf(nodes[nodeIndex], begin, end);
+                return;
+            }
+            if (mid == begin) mid = splitMedian(data, cMin, cMax, begin, end);
+
+            auto left = static_cast<std::uint32_t>(nodes.size());
+            nodes[nodeIndex].index = left;
+            nodes[nodeIndex].count = 0;
+            nodes.emplace_back();
+            nodes.emplace_back();
+            buildChildren(nodes, left, begin, mid, end, threads,
+                [&](node_array &subNodes, std::uint32_t subIndex, std::uint32_t b, std::uint32_t e, int t)
+                { buildNode(data, subNodes, subIndex, b, e, depth + 1, t); });
+        }
+
+        // returns the partition point of the best binned SAH split, 'end' if a leaf
+        // is cheaper, or 'begin' if the centroids cannot be separated by binning
+        std::uint32_t splitSAH(const BuildData &data, const node_type &node,
+                               const value_type cMin[3], const value_type cMax[3],
+                               std::uint32_t begin, std::uint32_t end, int threads)
+        {
+            auto n = end - begin;
+            value_type scale[3];
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                auto extent = cMax[axis] - cMin[axis];
+                scale[axis] = (extent > 0) ? binCount / extent : value_type(0);
+            }
+
+            auto blocks = (n >= parallelBinSize) ? threads : 1;
+            std::vector<BinSet> partial(blocks);
+            gParallel::forBlocks(begin, end, blocks, [&](int block, std::size_t b, std::size_t e)
+            {
+                auto bins = partial[block].bins;
+                resetBins(bins);
+                for (auto i = b; i < e; ++i)
+                {
+                    auto p = _order[i];
+                    for (int axis = 0; axis < 3; ++axis)
+                    {
+                        if (scale[axis] == 0) continue;
+                        auto &bin = bins[axis][binIndex(data.centroid[3 * p + axis], cMin[axis], scale[axis])];
+                        growBox(bin.boxMin, bin.boxMax, &data.boxMin[3 * p], &data.boxMax[3 * p]);
+                        ++bin.count;
+                    }
+                }
+            });
+
+            Bin bins[3][binCount];
+            resetBins(bins);
+            for (int block = 0; block < blocks; ++block)
+            {
+                const auto &blockBins = partial[block].bins;
+                for (int axis = 0; axis < 3; ++axis)
+                    for (int b = 0; b < binCount; ++b)
+                    {
+                        growBox(bins[axis][b].boxMin, bins[axis][b].boxMax, blockBins[axis][b].boxMin, blockBins[axis][b].boxMax);
+                        bins[axis][b].count += blockBins[axis][b].count;
+                    }
+            }
+
+            auto bestCost = std::numeric_limits<value_type>::max();
+            int bestAxis = -1, bestBin = 0;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                if (scale[axis] == 0) continue;
+
+                // sweep from the right to get the cost of every right-hand side
+                value_type rightArea[binCount];
+                std::uint32_t rightCount[binCount];
+                value_type bMin[3], bMax[3];
+                resetBox(bMin, bMax);
+                std::uint32_t count = 0;
+                for (int b = binCount - 1; b > 0; --b)
+                {
+                    growBox(bMin, bMax, bins[axis][b].boxMin, bins[axis][b].boxMax);
+                    count += bins[axis][b].count;
+                    rightArea[b] = (count > 0) ? halfArea(bMin, bMax) : 0;
+                    rightCount[b] = count;
+                }
+
+                resetBox(bMin, bMax);
+                count = 0;
+                for (int b = 1; b < binCount; ++b)
+                {
+                    growBox(bMin, bMax, bins[axis][b - 1].boxMin, bins[axis][b - 1].boxMax);
+                    count += bins[axis][b - 1].count;
+                    if (count == 0 || rightCount[b] == 0) continue;
+                    auto cost = halfArea(bMin, bMax) * count + rightArea[b] * rightCount[b];
+                    if (cost < bestCost)
+                    {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestBin = b;
+                    }
+                }
+            }
+
+            if (bestAxis < 0) return (n <= static_cast<std::uint32_t>(_maxLeafSize)) ? end : begin;
+
+            // cost of traversal = 1, cost of primitive test = 1
+            auto area = halfArea(node.boxMin, node.boxMax);
+            auto splitCost = 1 + ((area > 0) ? bestCost / area : value_type(0));
+            if (n <= static_cast<std::uint32_t>(_maxLeafSize) && n <= splitCost) return end;
+
+            auto axisMin = cMin[bestAxis], axisScale = scale[bestAxis];
+            return partition(begin, end, [&](std::uint32_t p)
+                { return binIndex(data.centroid[3 * p + bestAxis], axisMin, axisScale) < bestBin; }, threads);
+        }
+
+        std::uint32_t splitMedian(const BuildData &data, const value_type cMin[3], const value_type cMax[3],
+                                  std::uint32_t begin, std::uint32_t end)
+        {
+            int axis = 0;
+            for (int k = 1; k < 3; ++k)
+                if (cMax[k] - cMin[k] > cMax[axis] - cMin[axis]) axis = k;
+
+            auto mid = begin + (end - begin) / 2;
+            std::nth_element(_order.begin() + begin, _order.begin() + mid, _order.begin() + end,
+                [&](std::uint32_t a, std::uint32_t b)
+                { return data.centroid[3 * a + axis] < data.centroid[3 * b + axis]; });
+            return mid;
+        }
+
+        // sort by blocks on all threads, then merge neighbouring blocks pairwise
+        static void sortKeys(std::vector<std::uint64_t> &keys, int threads)
+        {
+            if (threads <= 1 || keys.size() < parallelBinSize)
+            {
+                std::sort(keys.begin(), keys.end());
+                return;
+            }
+
+            std::vector<std::size_t> bounds(threads + 1, keys.size());
+            gParallel::forBlocks(0, keys.size(), threads, [&](int block, std::size_t b, std::size_t e)
+            {
+                bounds[block] = b;
+                std::sort(keys.begin() + b, keys.begin() + e);
+            });
+            for (int block = threads - 1; block >= 0; --block)
+                bounds[block] = std::min(bounds[block], bounds[block + 1]);
+
+            for (std::size_t width = 1; width < static_cast<std::size_t>(threads); width *= 2)
+            {
+                auto pairs = (threads + 2 * width - 1) / (2 * width);
+                gParallel::forBlocks(0, pairs, static_cast<int>(pairs), [&](int, std::size_t pb, std::size_t pe)
+                {
+                    for (auto pair = pb; pair < pe; ++pair)
+                    {
+                        auto b = bounds[std::min(2 * width * pair, static_cast<std::size_t>(threads))];
+                        auto m = bounds[std::min(2 * width * pair + width, static_cast<std::size_t>(threads))];
+                        auto e = bounds[std::min(2 * width * (pair + 1), static_cast<std::size_t>(threads))];
+                        std::inplace_merge(keys.begin() + b, keys.begin() + m, keys.begin() + e);
+                    }
+                });
+            }
+        }
+
+        // index of the first code of [begin, end) that has the highest differing bit set,
+        // the middle of the range if all codes are equal
+        static std::uint32_t splitMorton(const std::vector<std::uint32_t> &codes, std::uint32_t begin, std::uint32_t end)
+        {
+            auto diff = codes[begin] ^ codes[end - 1];
+            if (diff == 0) return begin + (end - begin) / 2;
+
+            std::uint32_t bit = 1u << 31;
+            while ((diff & bit) == 0) bit >>= 1;
+            auto it = std::partition_point(codes.begin() + begin, codes.begin() + end,
+                [bit](std::uint32_t code) { return (code & bit) == 0; });
+            return static_cast<std::uint32_t>(it - codes.begin());
+        }
+
+        void buildMortonNode(const BuildData &data, const std::vector<std::uint32_t> &codes, node_array &nodes,
+                             std::uint32_t nodeIndex, std::uint32_t begin, std::uint32_t end, int threads)
+        {
+            if (end - begin <= static_cast<std::uint32_t>(_maxLeafSize))
+            {
+                auto &node = nodes[nodeIndex];
+                resetBox(node.boxMin, node.boxMax);
+                for (auto i = begin; i < end; ++i)
+                    growBox(node.boxMin, node.boxMax, &data.boxMin[3 * _order[i]], &data.boxMax[3 * _order[i]]);
+                makeLeaf(node, begin, end);
+                return;
+            }
+
+            auto mid = splitMorton(codes, begin, end);
+            auto left = static_cast<std::uint32_t>(nodes.size());
+            nodes[nodeIndex].index = left;
+            nodes[nodeIndex].count = 0;
+            nodes.emplace_back();
+            nodes.emplace_back();
+            buildChildren(nodes, left, begin, mid, end, threads,
+                [&](node_array &subNodes, std::uint32_t subIndex, std::uint32_t b, std::uint32_t e, int t)
+                { buildMortonNode(data, codes, subNodes, subIndex, b, e, t); });
+
+            auto &node = nodes[nodeIndex];
+            resetBox(node.boxMin, node.boxMax);
+            growBox(node.boxMin, node.boxMax, nodes[left].boxMin, nodes[left].boxMax);
+            growBox(node.boxMin, node.boxMax, nodes[left + 1].boxMin, nodes[left + 1].boxMax);
+        }
+
+        int _maxLeafSize;
+        int _threadCount;
+        node_array _nodes;
+        std::vector<std::uint32_t> _order;
+    };
+
+    using BVH3d = BVH3<double>;
+    using BVH3f = BVH3<float>;
+}
+
+#endif
@@ -0,0 +1,436 @@
+﻿#ifndef G3_SPATIAL_DYNAMIC_BVH_3
+#define G3_SPATIAL_DYNAMIC_BVH_3
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+
+#include <math/AxisAlignedBox3.h>
+#include <math/Box3.h>
+#include <math/frame3.h>
+
+namespace g3
+{
+    // Incremental bounding volume hierarchy over moving objects ("proxies").
+    // Nodes live in a pool with a free list, so proxy ids stay valid until removed.
+    // Leaves store fat bounds (tight bounds grown by margin()); moving a proxy inside
+    // its fat bounds costs nothing, otherwise the leaf is flagged as moved and only
+    // its ancestors are refit by refit(). Inserts walk down by least surface area
+    // growth and every node on the way back up is improved by a tree rotation;
+    // rebalance() applies the same rotations to the whole tree.
+    // Queries see the node bounds as of the last refit().
+    template<typename T>
+    class DynamicBVH3
+    {
+    public:
+        using vector_type = typename Vector3Traits<T>::vector_type;
+        using value_type  = typename vector_type::value_type;
+        using box_type    = AxisAlignedBox3<T>;
+        using obb_type    = Box3<T>;
+        using frame_type  = Frame3<T>;
+        using self_type   = DynamicBVH3<T>;
+
+        struct Node
+        {
+            value_type boxMin[3], boxMax[3];
+            int parent;            // next free node while on the free list
+            int child0, child1;    // -1 for leaves
+            int height;            // 0 for leaves, -1 for free nodes
+            int userData;
+            bool moved;
+
+            bool isLeaf() const { return child0 < 0; }
+        };
+
+        // static functions
+        // world space bounds of 'localBox' posed by 'frame'
+        static box_type worldBounds(const frame_type &frame, const obb_type &localBox)
+        {
+            auto rot = frame.rotationMatrix();
+            auto center = frame.fromFrameP(localBox.center());
+            auto ext = localBox.extent();
+            vector_type axes[3] = { rot * localBox.axisX(), rot * localBox.axisY(), rot * localBox.axisZ() };
+            vector_type half;
+            for (int k = 0; k < 3; ++k)
+                half[k] = std::abs(axes[0][k]) * ext[0] + std::abs(axes[1][k]) * ext[1] + std::abs(axes[2][k]) * ext[2];
+            return box_type(center - half, center + half);
+        }
+
+        // constructors
+        DynamicBVH3() : _root(-1), _freeList(-1), _proxyCount(0), _margin(0) {}
+
+        // functions
+        // fat bounds of a leaf are the tight bounds grown by this value on every side
+        value_type margin() const { return _margin; }
+        void setMargin(value_type m) { _margin = std::max(m, value_type(0)); }
+
+        std::size_t proxyCount() const { return _proxyCount; }
+        bool empty() const { return _root < 0; }
+        int root() const { return _root; }
+        const Node& node(int i) const { return _nodes[i]; }
+        int height() const { return (_root < 0) ? 0 : _nodes[_root].height; }
+        int userData(int proxy) const { return _nodes[proxy].userData; }
+
+        box_type fatBounds(int proxy) const { return toBox(_nodes[proxy]); }
+
+        box_type bounds() const
+        { return (_root < 0) ? box_type::empty : toBox(_nodes[_root]); }
+
+        // O(log n) for a balanced tree; returns the proxy id
+        int insert(const box_type &bounds, int userData = -1)
+        {
+            auto leaf = allocateNode();
+            auto &n = _nodes[leaf];
+            setFatBox(n, bounds);
+            n.userData = userData;
+            n.height = 0;
+            insertLeaf(leaf);
+            markMoved(leaf);
+            ++_proxyCount;
+            return leaf;
+        }
+
+        // proxy of a rigid body with body space bounds 'localBox' posed by 'frame'
+        int insert(const obb_type &localBox, const frame_type &frame, int userData = -1)
+        {
+            auto proxy = insert(worldBounds(frame, localBox), userData);
+            if (_local.size() < _nodes.size()) _local.resize(_nodes.size(), obb_type(vector_type::zero));
+            _local[proxy] = localBox;
+            return proxy;
+        }
+
+        void remove(int proxy)
+        {
+            if (_nodes[proxy].moved)
+                _moved.erase(std::find(_moved.begin(), _moved.end(), proxy));
+            removeLeaf(proxy);
+            freeNode(proxy);
+            --_proxyCount;
+        }
+
+        // New tight bounds of a proxy. Returns true and flags the proxy as moved if they left
+        // its fat bounds; the ancestors are updated by the next refit().
+        bool setBounds(int proxy, const box_type &bounds)
+        {
+            auto &n = _nodes[proxy];
+            auto bmin = bounds.minCoordinate(), bmax = bounds.maxCoordinate();
+            bool inside = true;
+            for (int k = 0; k < 3; ++k)
+                inside = inside && n.boxMin[k] <= bmin[k] && n.boxMax[k] >= bmax[k];
+            if (inside) return false;
+
+            setFatBox(n, bounds);
+            markMoved(proxy);
+            return true;
+        }
+
+        // new pose of a proxy inserted with body space bounds
+        bool setFrame(int proxy, const frame_type &frame)
+        { return setBounds(proxy, worldBounds(frame, _local[proxy])); }
+
+        // proxies flagged as moved (or inserted) since the last clearMoved()
+        const std::vector<int>& movedProxies() const { return _moved; }
+
+        void clearMoved()
+        {
+            for (auto proxy : _moved) _nodes[proxy].moved = false;
+            _moved.clear();
+        }
+
+        // bottom-up refit of the ancestors of the moved proxies; a walk stops at the first
+        // node whose bounds do not change, so the cost only depends on what moved
+        void refit()
+        {
+            for (auto proxy : _moved)
+            {
+                for (auto i = _nodes[proxy].parent; i >= 0; i = _nodes[i].parent)
+                    if (!fitToChildren(i)) break;
+            }
+        }
+
+        // one pass of tree rotations over every inner node, children before parents
+        void rebalance()
+        {
+            if (_root < 0) return;
+            std::vector<int> order;
+            order.reserve(_nodes.size());
+            order.push_back(_root);
+            for (std::size_t i = 0; i < order.size(); ++i)
+            {
+                const auto &n = _nodes[order[i]];
+                if (!n.isLeaf()) { order.push_back(n.child0); order.push_back(n.child1); }
+            }
+            for (auto i = order.rbegin(); i != order.rend(); ++i)
+            {
+                if (_nodes[*i].isLeaf()) continue;
+                fitToChildren(*i);
+                rotate(*i);
+            }
+        }
+
+        // calls f(proxy) for every proxy whose fat bounds overlap 'box', f returns false to stop
+        template<typename F>
+        void query(const box_type &box, F f) const
+        {
+            if (_root < 0) return;
+            auto bmin = box.minCoordinate(), bmax = box.maxCoordinate();
+            value_type qMin[3] = { bmin.x(), bmin.y(), bmin.z() }, qMax[3] = { bmax.x(), bmax.y(), bmax.z() };
+
+            std::vector<int> stack;
+            stack.reserve(64);
+            stack.push_back(_root);
+            while (!stack.empty())
+            {
+                auto i = stack.back();
+                stack.pop_back();
+                const auto &n = _nodes[i];
+                if (!overlaps(n, qMin, qMax)) continue;
+                if (n.isLeaf())
+                {
+                    if (!f(i)) return;
+                }
+                else
+                {
+                    stack.push_back(n.child1);
+                    stack.push_back(n.child0);
+                }
+            }
+        }
+
+        // Calls f(a, b) with a < b once for every pair of overlapping fat bounds that
+        // involves a moved proxy. Call refit() first.
+        template<typename F>
+        void findMovedPairs(F f) const
+        {
+            for (auto proxy : _moved)
+            {
+                query(toBox(_nodes[proxy]), [&](int other)
+                {
+                    // a pair of two moved proxies is reported by the smaller id only
+                    if (other == proxy || (_nodes[other].moved && other < proxy)) return true;
+                    f(std::min(proxy, other), std::max(proxy, other));
+                    return true;
+                });
+            }
+        }
+
+    private:
+        static value_type halfArea(const value_type boxMin[3], const value_type boxMax[3])
+        {
+            auto dx = boxMax[0] - boxMin[0], dy = boxMax[1] - boxMin[1], dz = boxMax[2] - boxMin[2];
+            return dx * dy + dy * dz + dz * dx;
+        }
+
+        static value_type unionArea(const Node &a, const Node &b)
+        {
+            value_type bmin[3], bmax[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                bmin[k] = std::min(a.boxMin[k], b.boxMin[k]);
+                bmax[k] = std::max(a.boxMax[k], b.boxMax[k]);
+            }
+            return halfArea(bmin, bmax);
+        }
+
+        static bool overlaps(const Node &n, const value_type boxMin[3], const value_type boxMax[3])
+        {
+            return n.boxMin[0] <= boxMax[0] && n.boxMax[0] >= boxMin[0] &&
+                   n.boxMin[1] <= boxMax[1] && n.boxMax[1] >= boxMin[1] &&
+                   n.boxMin[2] <= boxMax[2] && n.boxMax[2] >= boxMin[2];
+        }
+
+        static box_type toBox(const Node &n)
+        { return box_type(n.boxMin[0], n.boxMin[1], n.boxMin[2], n.boxMax[0], n.boxMax[1], n.boxMax[2]); }
+
+        void setFatBox(Node &n, const box_type &bounds)
+        {
+            auto bmin = bounds.minCoordinate(), bmax = bounds.maxCoordinate();
+            for (int k = 0; k < 3; ++k)
+            {
+                n.boxMin[k] = bmin[k] - _margin;
+                n.boxMax[k] = bmax[k] + _margin;
+            }
+        }
+
+        void markMoved(int proxy)
+        {
+            if (_nodes[proxy].moved) return;
+            _nodes[proxy].moved = true;
+            _moved.push_back(proxy);
+        }
+
+        int allocateNode()
+        {
+            int i;
+            if (_freeList >= 0)
+            {
+                i = _freeList;
+                _freeList = _nodes[i].parent;
+            }
+            else
+            {
+                i = static_cast<int>(_nodes.size());
+                _nodes.emplace_back();
+            }
+            auto &n = _nodes[i];
+            n.parent = n.child0 = n.child1 = -1;
+            n.height = 0;
+            n.userData = -1;
+            n.moved = false;
+            return i;
+        }
+
+        void freeNode(int i)
+        {
+            _nodes[i].parent = _freeList;
+            _nodes[i].height = -1;
+            _freeList = i;
+        }
+
+        // recomputes bounds and height from the children; returns false if the bounds did not change
+        bool fitToChildren(int i)
+        {
+            auto &n = _nodes[i];
+            const auto &c0 = _nodes[n.child0], &c1 = _nodes[n.child1];
+            bool changed = false;
+            for (int k = 0; k < 3; ++k)
+            {
+                auto bmin = std::min(c0.boxMin[k], c1.boxMin[k]), bmax = std::max(c0.boxMax[k], c1.boxMax[k]);
+                changed = changed || bmin != n.boxMin[k] || bmax != n.boxMax[k];
+                n.boxMin[k] = bmin;
+                n.boxMax[k] = bmax;
+            }
+            n.height = 1 + std::max(c0.height, c1.height);
+            return changed;
+        }
+
+        void insertLeaf(int leaf)
+        {
+            if (_root < 0)
+            {
+                _root = leaf;
+                _nodes[leaf].parent = -1;
+                return;
+            }
+
+            // descend to the sibling with the least total growth of surface area
+            const auto &l = _nodes[leaf];
+            auto sibling = _root;
+            while (!_nodes[sibling].isLeaf())
+            {
+                const auto &n = _nodes[sibling];
+                auto area = halfArea(n.boxMin, n.boxMax);
+                auto combined = unionArea(n, l);
+                auto cost = 2 * combined;
+                auto inheritance = 2 * (combined - area);
+
+                auto childCost = [&](int c)
+                {
+                    const auto &cn = _nodes[c];
+                    auto grown = unionArea(cn, l);
+                    return (cn.isLeaf() ? grown : grown - halfArea(cn.boxMin, cn.boxMax)) + inheritance;
+                };
+                auto cost0 = childCost(n.child0), cost1 = childCost(n.child1);
+                if (cost < cost0 && cost < cost1) break;
+                sibling = (cost0 <= cost1) ? n.child0 : n.child1;
+            }
+
+            auto oldParent = _nodes[sibling].parent;
+            auto newParent = allocateNode();
+            auto &p = _nodes[newParent];
+            p.parent = oldParent;
+            p.child0 = sibling;
+            p.child1 = leaf;
+            _nodes[sibling].parent = newParent;
+            _nodes[leaf].parent = newParent;
+            if (oldParent < 0) _root = newParent;
+            else if (_nodes[oldParent].child0 == sibling) _nodes[oldParent].child0 = newParent;
+            else _nodes[oldParent].child1 = newParent;
+
+            for (auto i = newParent; i >= 0; i = _nodes[i].parent)
+            {
+                fitToChildren(i);
+                rotate(i);
+            }
+        }
+
+        void removeLeaf(int leaf)
+        {
+            if (leaf == _root)
+            {
+                _root = -1;
+                return;
+            }
+
+            auto parent = _nodes[leaf].parent;
+            auto grandParent = _nodes[parent].parent;
+            auto sibling = (_nodes[parent].child0 == leaf) ? _nodes[parent].child1 : _nodes[parent].child0;
+            _nodes[sibling].parent = grandParent;
+            freeNode(parent);
+            if (grandParent < 0)
+            {
+                _root = sibling;
+                return;
+            }
+
+            if (_nodes[grandParent].child0 == parent) _nodes[grandParent].child0 = sibling;
+            else _nodes[grandParent].child1 = sibling;
+            for (auto i = grandParent; i >= 0; i = _nodes[i].parent)
+            {
+                fitToChildren(i);
+                rotate(i);
+            }
+        }
+
+        // Tree rotation at inner node i (Kopta et al. 2012): swapping a child with a
+        // grandchild on the other side leaves the bounds of i unchanged, so the rotation
+        // that most reduces the surface area of the modified child is applied, if any.
+        void rotate(int i)
+        {
+            const auto &n = _nodes[i];
+            auto b = n.child0, c = n.child1;
+            value_type bestGain = 0;
+            int bestChild = -1, bestGrandChild = -1, bestOther = -1;
+
+            auto consider = [&](int child, int other)
+            {
+                const auto &o = _nodes[other];
+                if (o.isLeaf()) return;
+                auto area = halfArea(o.boxMin, o.boxMax);
+                // swap 'child' with o.child0, so 'other' bounds child and o.child1
+                auto gain0 = area - unionArea(_nodes[child], _nodes[o.child1]);
+                auto gain1 = area - unionArea(_nodes[child], _nodes[o.child0]);
+                if (gain0 > bestGain) { bestGain = gain0; bestChild = child; bestGrandChild = o.child0; bestOther = other; }
+                if (gain1 > bestGain) { bestGain = gain1; bestChild = child; bestGrandChild = o.child1; bestOther = other; }
+            };
+            consider(b, c);
+            consider(c, b);
+            if (bestChild < 0) return;
+
+            auto &node = _nodes[i];
+            auto &other = _nodes[bestOther];
+            if (node.child0 == bestChild) node.child0 = bestGrandChild;
+            else node.child1 = bestGrandChild;
+            if (other.child0 == bestGrandChild) other.child0 = bestChild;
+            else other.child1 = bestChild;
+            _nodes[bestGrandChild].parent = i;
+            _nodes[bestChild].parent = bestOther;
+            fitToChildren(bestOther);
+            fitToChildren(i);
+        }
+
+        std::vector<Node> _nodes;
+        std::vector<obb_type> _local;
+        std::vector<int> _moved;
+        int _root;
+        int _freeList;
+        std::size_t _proxyCount;
+        value_type _margin;
+    };
+
+    using DynamicBVH3d = DynamicBVH3<double>;
+    using DynamicBVH3f = DynamicBVH3<float>;
+}
+
+#endif
@@ -0,0 +1,178 @@
+﻿#ifndef G3_SPATIAL_OBB_TREE_3
+#define G3_SPATIAL_OBB_TREE_3
+
+#include <cstddef>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include <math/Box3.h>
+
+namespace g3
+{
+    // Hierarchy of oriented boxes over a set of Box3, one input box per leaf.
+    // Built top-down by median split of the box centers along their widest spread;
+    // every inner box is Box3::merge of its two children, so it contains all the
+    // boxes below it. Query results are indices into the array passed to build().
+    template<typename T>
+    class OBBTree3
+    {
+    public:
+        using vector_type = typename Vector3Traits<T>::vector_type;
+        using value_type  = typename vector_type::value_type;
+        using box_type    = Box3<T>;
+        using pair_type   = std::pair<int, int>;
+        using self_type   = OBBTree3<T>;
+
+        struct Node
+        {
+            box_type box;
+            int index;   // leaf: input box index, inner: first of the two adjacent children
+            bool leaf;
+
+            Node() : box(vector_type::zero), index(-1), leaf(true) {}
+        };
+
+        // constructors
+        OBBTree3() {}
+        OBBTree3(const std::vector<box_type> &boxes) { build(boxes); }
+
+        // functions
+        void build(const box_type *boxes, std::size_t count)
+        {
+            _nodes.clear();
+            if (count == 0) return;
+
+            std::vector<int> order(count);
+            for (std::size_t i = 0; i < count; ++i) order[i] = static_cast<int>(i);
+            _nodes.reserve(2 * count - 1);
+            _nodes.emplace_back();
+            buildNode(boxes, order, 0, 0, static_cast<int>(count));
+        }
+
+        void build(const std::vector<box_type> &boxes)
+        { build(boxes.data(), boxes.size()); }
+
+        bool empty() const { return _nodes.empty(); }
+        std::size_t nodeCount() const { return _nodes.size(); }
+        const Node& node(std::size_t i) const { return _nodes[i]; }
+
+        // indices of the leaf boxes overlapping 'box' grown by 'clearance', appended to 'boxes'
+        void findOverlappingBoxes(const box_type &box, std::vector<int> &boxes, value_type clearance = 0) const
+        {
+            if (_nodes.empty()) return;
+            std::vector<int> stack(1, 0);
+            while (!stack.empty())
+            {
+                const auto &n = _nodes[stack.back()];
+                stack.pop_back();
+                if (!box.intersects(n.box, clearance)) continue;
+                if (n.leaf) boxes.push_back(n.index);
+                else
+                {
+                    stack.push_back(n.index + 1);
+                    stack.push_back(n.index);
+                }
+            }
+        }
+
+        // Pairs (i, j) of a leaf box i of this tree and a leaf box j of 'other' that overlap,
+        // the boxes of this tree grown by 'clearance'; appended to 'pairs'. Both trees
+        // are descended together, always splitting the larger of the two nodes.
+        // A leaf grown along its own axes reaches up to clearance * sqrt(3) out of its
+        // parent's box in any direction, so inner boxes of this tree are grown by that
+        // much instead; the exact test is only made between two leaves.
+        void findOverlappingPairs(const self_type &other, std::vector<pair_type> &pairs, value_type clearance = 0) const
+        {
+            traversePairs(other, clearance, [&](int i, int j) { pairs.emplace_back(i, j); return true; });
+        }
+
+        // true if any leaf box of this tree, grown by 'clearance', overlaps one of 'other'
+        bool testAnyOverlap(const self_type &other, value_type clearance = 0) const
+        {
+            bool found = false;
+            traversePairs(other, clearance, [&](int, int) { found = true; return false; });
+            return found;
+        }
+
+    private:
+        void buildNode(const box_type *boxes, std::vector<int> &order, int nodeIndex, int begin, int end)
+        {
+            if (end - begin == 1)
+            {
+                _nodes[nodeIndex].box = boxes[order[begin]];
+                _nodes[nodeIndex].index = order[begin];
+                _nodes[nodeIndex].leaf = true;
+                return;
+            }
+
+            vector_type cMin = boxes[order[begin]].center(), cMax = cMin;
+            for (int i = begin + 1; i < end; ++i)
+            {
+                auto c = boxes[order[i]].center();
+                for (int k = 0; k < 3; ++k)
+                {
+                    cMin[k] = std::min(cMin[k], c[k]);
+                    cMax[k] = std::max(cMax[k], c[k]);
+                }
+            }
+            int axis = 0;
+            for (int k = 1; k < 3; ++k)
+                if (cMax[k] - cMin[k] > cMax[axis] - cMin[axis]) axis = k;
+
+            auto mid = begin + (end - begin) / 2;
+            std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+                [&](int a, int b) { return boxes[a].center()[axis] < boxes[b].center()[axis]; });
+
+            auto left = static_cast<int>(_nodes.size());
+            _nodes.emplace_back();
+            _nodes.emplace_back();
+            buildNode(boxes, order, left, begin, mid);
+            buildNode(boxes, order, left + 1, mid, end);
+
+            auto &n = _nodes[nodeIndex];
+            n.box = box_type::merge(_nodes[left].box, _nodes[left + 1].box);
+            n.index = left;
+            n.leaf = false;
+        }
+
+        template<typename PairFunc>
+        void traversePairs(const self_type &other, value_type clearance, PairFunc pairFunc) const
+        {
+            if (_nodes.empty() || other._nodes.empty()) return;
+            auto innerClearance = clearance * std::sqrt(value_type(3));
+            std::vector<pair_type> stack(1, pair_type(0, 0));
+            while (!stack.empty())
+            {
+                auto p = stack.back();
+                stack.pop_back();
+                const auto &a = _nodes[p.first];
+                const auto &b = other._nodes[p.second];
+                if (!a.box.intersects(b.box, a.leaf ? clearance : innerClearance)) continue;
+
+                if (a.leaf && b.leaf)
+                {
+                    if (!pairFunc(a.index, b.index)) return;
+                }
+                else if (b.leaf || (!a.leaf && a.box.volume() >= b.box.volume()))
+                {
+                    stack.emplace_back(a.index + 1, p.second);
+                    stack.emplace_back(a.index, p.second);
+                }
+                else
+                {
+                    stack.emplace_back(p.first, b.index + 1);
+                    stack.emplace_back(p.first, b.index);
+                }
+            }
+        }
+
+        std::vector<Node> _nodes;
+    };
+
+    using OBBTree3d = OBBTree3<double>;
+    using OBBTree3f = OBBTree3<float>;
+}
+
+#endif
@@ -0,0 +1,336 @@
+﻿#ifndef G3_SPATIAL_SWEEP_AND_PRUNE_3
+#define G3_SPATIAL_SWEEP_AND_PRUNE_3
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <math/AxisAlignedBox3.h>
+
+namespace g3
+{
+    // Sweep-and-prune broad-phase over axis aligned boxes. Box endpoints are kept in
+    // sorted lists that are repaired by insertion sort when a box moves, which is close
+    // to linear for temporally coherent motion. Boxes touching at a face count as
+    // overlapping.
+    //   3 axes: every endpoint swap between a min and a max updates the overlapping
+    //           pair set at once, so its cost only depends on what moved.
+    //   1 axis: only x is sorted; updatePairs() sweeps the list once and compares with
+    //           the previous pairs. Cheaper to maintain, better for a few large moves.
+    // updatePairs() reports the pairs added and removed since the previous call; a
+    // pair that appeared and vanished in between is not reported.
+    template<typename T>
+    class SweepAndPrune3
+    {
+        static_assert(std::is_floating_point<T>::value, "SweepAndPrune3 requires float or double");
+
+    public:
+        using vector_type = typename Vector3Traits<T>::vector_type;
+        using value_type  = typename vector_type::value_type;
+        using box_type    = AxisAlignedBox3<T>;
+        using pair_type   = std::pair<int, int>;
+        using self_type   = SweepAndPrune3<T>;
+
+        // constructors
+        explicit SweepAndPrune3(int axisCount = 3) : _axisCount((axisCount == 1) ? 1 : 3), _handleCount(0) {}
+
+        // functions
+        int axisCount() const { return _axisCount; }
+        std::size_t handleCount() const { return _handleCount; }
+        int userData(int handle) const { return _handles[handle].userData; }
+
+        box_type bounds(int handle) const
+        {
+            const auto &h = _handles[handle];
+            return box_type(h.boxMin[0], h.boxMin[1], h.boxMin[2], h.boxMax[0], h.boxMax[1], h.boxMax[2]);
+        }
+
+        // Returns the handle of the new box. Handles of removed boxes are recycled
+        // only after the next updatePairs(), so reported pairs are never ambiguous.
+        int add(const box_type &box, int userData = -1)
+        {
+            int handle;
+            if (!_freeHandles.empty())
+            {
+                handle = _freeHandles.back();
+                _freeHandles.pop_back();
+            }
+            else
+            {
+                handle = static_cast<int>(_handles.size());
+                _handles.emplace_back();
+            }
+            auto &h = _handles[handle];
+            setBox(h, box);
+            h.userData = userData;
+            h.alive = true;
+
+            // enter at the end of every list and sort down
+            for (int axis = 0; axis < _axisCount; ++axis)
+            {
+                auto &list = _endpoints[axis];
+                auto index = static_cast<std::uint32_t>(list.size());
+                list.push_back({ h.boxMin[axis], endpointData(handle, false) });
+                list.push_back({ h.boxMax[axis], endpointData(handle, true) });
+                h.endpoint[axis][0] = index;
+                h.endpoint[axis][1] = index + 1;
+                sortDown(axis, index, false);
+                sortDown(axis, _handles[handle].endpoint[axis][1], false);
+            }
+            ++_handleCount;
+            return handle;
+        }
+
+        void remove(int handle)
+        {
+            // sorting the endpoints up to the end of the lists drops the pairs of 'handle'
+            auto &h = _handles[handle];
+            for (int k = 0; k < 3; ++k)
+                h.boxMin[k] = h.boxMax[k] = std::numeric_limits<value_type>::infinity();
+            for (int axis = 0; axis < _axisCount; ++axis)
+            {
+                auto &list = _endpoints[axis];
+                list[h.endpoint[axis][1]].value = h.boxMax[axis];
+                sortUp(axis, h.endpoint[axis][1], true);
+                list[h.endpoint[axis][0]].value = h.boxMin[axis];
+                sortUp(axis, h.endpoint[axis][0], true);
+                list.pop_back();
+                list.pop_back();
+            }
+            h.alive = false;
+            _pendingHandles.push_back(handle);
+            --_handleCount;
+        }
+
+        void update(int handle, const box_type &box)
+        {
+            auto &h = _handles[handle];
+            value_type oldMin[3], oldMax[3];
+            std::copy(h.boxMin, h.boxMin + 3, oldMin);
+            std::copy(h.boxMax, h.boxMax + 3, oldMax);
+            setBox(h, box);
+
+            // grow first, then shrink, so that a min never passes its own max
+            for (int axis = 0; axis < _axisCount; ++axis)
+            {
+                auto &list = _endpoints[axis];
+                list[h.endpoint[axis][0]].value = h.boxMin[axis];
+                list[h.endpoint[axis][1]].value = h.boxMax[axis];
+                if (h.boxMin[axis] < oldMin[axis]) sortDown(axis, h.endpoint[axis][0], false);
+                if (h.boxMax[axis] > oldMax[axis]) sortUp(axis, h.endpoint[axis][1], false);
+                if (h.boxMin[axis] > oldMin[axis]) sortUp(axis, h.endpoint[axis][0], false);
+                if (h.boxMax[axis] < oldMax[axis]) sortDown(axis, h.endpoint[axis][1], false);
+            }
+        }
+
+        // pairs (a, b) with a < b that started or stopped overlapping since the previous call
+        void updatePairs(std::vector<pair_type> &added, std::vector<pair_type> &removed)
+        {
+            added.clear();
+            removed.clear();
+            if (_axisCount == 1)
+            {
+                auto previous = std::move(_sweepPairs);
+                sweep(_sweepPairs);
+                std::vector<std::uint64_t> delta;
+                std::set_difference(_sweepPairs.begin(), _sweepPairs.end(), previous.begin(), previous.end(),
+                                    std::back_inserter(delta));
+                for (auto key : delta) added.push_back(toPair(key));
+                delta.clear();
+                std::set_difference(previous.begin(), previous.end(), _sweepPairs.begin(), _sweepPairs.end(),
+                                    std::back_inserter(delta));
+                for (auto key : delta) removed.push_back(toPair(key));
+            }
+            else
+            {
+                for (const auto &d : _delta)
+                    (d.second > 0 ? added : removed).push_back(toPair(d.first));
+                _delta.clear();
+                std::sort(added.begin(), added.end());
+                std::sort(removed.begin(), removed.end());
+            }
+
+            _freeHandles.insert(_freeHandles.end(), _pendingHandles.begin(), _pendingHandles.end());
+            _pendingHandles.clear();
+        }
+
+        // number of overlapping pairs; with one axis, as of the last updatePairs()
+        std::size_t pairCount() const
+        { return (_axisCount == 1) ? _sweepPairs.size() : _pairs.size(); }
+
+        // calls f(a, b) for every overlapping pair; with one axis, as of the last updatePairs()
+        template<typename F>
+        void forEachPair(F f) const
+        {
+            if (_axisCount == 1) { for (auto key : _sweepPairs) f(toPair(key).first, toPair(key).second); }
+            else { for (auto key : _pairs) f(toPair(key).first, toPair(key).second); }
+        }
+
+    private:
+        struct Endpoint
+        {
+            value_type value;
+            std::uint32_t data;   // handle * 2 + 1 for a max endpoint
+
+            bool isMax() const { return (data & 1) != 0; }
+            int handle() const { return static_cast<int>(data >> 1); }
+        };
+
+        struct Handle
+        {
+            value_type boxMin[3], boxMax[3];
+            std::uint32_t endpoint[3][2];   // list index of the min and max endpoint per axis
+            int userData;
+            bool alive;
+        };
+
+        static std::uint32_t endpointData(int handle, bool isMax)
+        { return (static_cast<std::uint32_t>(handle) << 1) | (isMax ? 1u : 0u); }
+
+        // at equal values min endpoints come first, so touching boxes overlap
+        static bool less(const Endpoint &a, const Endpoint &b)
+        { return a.value < b.value || (a.value == b.value && !a.isMax() && b.isMax()); }
+
+        static std::uint64_t pairKey(int a, int b)
+        {
+            if (a > b) std::swap(a, b);
+            return (static_cast<std::uint64_t>(a) << 32) | static_cast<std::uint32_t>(b);
+        }
+
+        static pair_type toPair(std::uint64_t key)
+        { return pair_type(static_cast<int>(key >> 32), static_cast<int>(key & 0xFFFFFFFFu)); }
+
+        static void setBox(Handle &h, const box_type &box)
+        {
+            auto bmin = box.minCoordinate(), bmax = box.maxCoordinate();
+            for (int k = 0; k < 3; ++k)
+            {
+                h.boxMin[k] = bmin[k];
+                h.boxMax[k] = bmax[k];
+            }
+        }
+
+        static bool overlaps(const Handle &a, const Handle &b)
+        {
+            return a.boxMin[0] <= b.boxMax[0] && b.boxMin[0] <= a.boxMax[0] &&
+                   a.boxMin[1] <= b.boxMax[1] && b.boxMin[1] <= a.boxMax[1] &&
+                   a.boxMin[2] <= b.boxMax[2] && b.boxMin[2] <= a.boxMax[2];
+        }
+
+        void addPair(std::uint64_t key)
+        {
+            if (!_pairs.insert(key).second) return;
+            auto it = _delta.find(key);
+            if (it != _delta.end() && it->second < 0) _delta.erase(it);
+            else _delta[key] = 1;
+        }
+
+        void removePair(std::uint64_t key)
+        {
+            if (_pairs.erase(key) == 0) return;
+            auto it = _delta.find(key);
+            if (it != _delta.end() && it->second > 0) _delta.erase(it);
+            else _delta[key] = -1;
+        }
+
+        // Overlap can only change when a min and a max endpoint swap places; the pair is then
+        // tested on the current coordinates of both boxes (3 axes only).
+        void swapEvent(const Endpoint &moving, const Endpoint &other, bool removing)
+        {
+            if (_axisCount == 1 || moving.isMax() == other.isMax()) return;
+            auto a = moving.handle(), b = other.handle();
+            if (removing || !overlaps(_handles[a], _handles[b])) removePair(pairKey(a, b));
+            else addPair(pairKey(a, b));
+        }
+
+        void swapEndpoints(int axis, std::uint32_t i, std::uint32_t j)
+        {
+            auto &list = _endpoints[axis];
+            std::swap(list[i], list[j]);
+            _handles[list[i].handle()].endpoint[axis][list[i].isMax() ? 1 : 0] = i;
+            _handles[list[j].handle()].endpoint[axis][list[j].isMax() ? 1 : 0] = j;
+        }
+
+        void sortDown(int axis, std::uint32_t i, bool removing)
+        {
+            auto &list = _endpoints[axis];
+            while (i > 0 && less(list[i], list[i - 1]))
+            {
+                swapEvent(list[i], list[i - 1], removing);
+                swapEndpoints(axis, i, i - 1);
+                --i;
+            }
+        }
+
+        void sortUp(int axis, std::uint32_t i, bool removing)
+        {
+            auto &list = _endpoints[axis];
+            auto n = static_cast<std::uint32_t>(list.size());
+            while (i + 1 < n && less(list[i + 1], list[i]))
+            {
+                swapEvent(list[i], list[i + 1], removing);
+                swapEndpoints(axis, i, i + 1);
+                ++i;
+            }
+        }
+
+        // one pass over the sorted x endpoints, testing y and z against the open intervals
+        void sweep(std::vector<std::uint64_t> &pairs)
+        {
+            pairs.clear();
+            _open.clear();
+            _openIndex.resize(_handles.size());
+            for (const auto &e : _endpoints[0])
+            {
+                auto handle = e.handle();
+                if (e.isMax())
+                {
+                    auto i = _openIndex[handle];
+                    _openIndex[_open.back()] = i;
+                    _open[i] = _open.back();
+                    _open.pop_back();
+                    continue;
+                }
+
+                const auto &h = _handles[handle];
+                for (auto other : _open)
+                {
+                    const auto &o = _handles[other];
+                    if (h.boxMin[1] <= o.boxMax[1] && o.boxMin[1] <= h.boxMax[1] &&
+                        h.boxMin[2] <= o.boxMax[2] && o.boxMin[2] <= h.boxMax[2])
+                        pairs.push_back(pairKey(handle, other));
+                }
+                _openIndex[handle] = static_cast<std::uint32_t>(_open.size());
+                _open.push_back(handle);
+            }
+            std::sort(pairs.begin(), pairs.end());
+        }
+
+        int _axisCount;
+        std::size_t _handleCount;
+        std::vector<Handle> _handles;
+        std::vector<int> _freeHandles, _pendingHandles;
+        std::vector<Endpoint> _endpoints[3];
+
+        // 3 axes: current pairs and their net change since the last updatePairs()
+        std::unordered_set<std::uint64_t> _pairs;
+        std::unordered_map<std::uint64_t, int> _delta;
+
+        // 1 axis: sorted pairs of the last sweep and sweep scratch
+        std::vector<std::uint64_t> _sweepPairs;
+        std::vector<int> _open;
+        std::vector<std::uint32_t> _openIndex;
+    };
+
+    using SweepAndPrune3d = SweepAndPrune3<double>;
+    using SweepAndPrune3f = SweepAndPrune3<float>;
+}
+
+#endif
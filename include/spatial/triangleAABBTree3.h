@@ -0,0 +1,310 @@
+﻿#ifndef G3_SPATIAL_TRIANGLE_AABB_TREE_3
+#define G3_SPATIAL_TRIANGLE_AABB_TREE_3
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <math/triangle3.h>
+#include <math/ray3.h>
+#include <math/rayPacket3.h>
+#include <spatial/bvh3.h>
+
+namespace g3
+{
+    // AABB tree over a triangle soup. The triangles are copied in leaf order next
+    // to the BVH, so a leaf test walks a contiguous block of memory.
+    // Query results are indices into the array passed to build(), or -1.
+    template<typename T>
+    class TriangleAABBTree3
+    {
+    public:
+        using vector_type   = typename Vector3Traits<T>::vector_type;
+        using value_type    = typename vector_type::value_type;
+        using triangle_type = Triangle3<T>;
+        using ray_type      = Ray3<T>;
+        using box_type      = AxisAlignedBox3<T>;
+        using bvh_type      = BVH3<T>;
+        using node_type     = typename bvh_type::node_type;
+        using self_type     = TriangleAABBTree3<T>;
+
+        // constructors
+        TriangleAABBTree3() {}
+        TriangleAABBTree3(const std::vector<triangle_type> &triangles) { build(triangles); }
+
+        // functions
+        void build(const triangle_type *triangles, std::size_t count)
+        {
+            std::vector<box_type> bounds;
+            bounds.reserve(count);
+            for (std::size_t i = 0; i < count; ++i) bounds.push_back(triangles[i].bounds());
+            _bvh.build(bounds);
+
+            _triangles.clear();
+            _triangles.reserve(count);
+            for (auto id : _bvh.primitiveOrder()) _triangles.push_back(triangles[id]);
+        }
+
+        void build(const std::vector<triangle_type> &triangles)
+        { build(triangles.data(), triangles.size()); }
+
+        const bvh_type& bvh() const { return _bvh; }
+        std::size_t triangleCount() const { return _triangles.size(); }
+
+        // index of the first triangle hit by 'ray' within 'maxDist', -1 if there is none;
+        // 'rayT' receives the ray parameter of the hit
+        int findNearestHitTriangle(const ray_type &ray, value_type maxDist, value_type &rayT) const
+        {
+            int hitID = -1;
+            auto bestT = maxDist;
+            traverseRay(ray, bestT, [&](std::uint32_t i, value_type t)
+            {
+                bestT = t;
+                hitID = static_cast<int>(_bvh.primitiveOrder()[i]);
+                return true;
+            });
+            if (hitID >= 0) rayT = bestT;
+            return hitID;
+        }
+
+        int findNearestHitTriangle(const ray_type &ray,
+                                   value_type maxDist = std::numeric_limits<value_type>::max()) const
+        {
+            value_type rayT;
+            return findNearestHitTriangle(ray, maxDist, rayT);
+        }
+
+        // Nearest hit of every ray of a coherent packet, traversing the tree once for all of
+        // them. hitIDs[i] receives the triangle hit by ray i or -1, rayT[i] its ray parameter
+        // (left unchanged when there is no hit).
+        template<int N>
+        void findNearestHitTriangles(const RayPacket3<T, N> &packet, value_type maxDist,
+                                     int hitIDs[N], value_type rayT[N]) const
+        {
+            value_type bestT[N], tNear[N];
+            for (int i = 0; i < N; ++i)
+            {
+                hitIDs[i] = -1;
+                bestT[i] = maxDist;
+            }
+            if (_bvh.empty() || packet.size() == 0) return;
+            const auto *nodes = _bvh.nodes();
+
+            // children are visited in the order met along the direction of the first ray
+            auto dir = packet.direction(0);
+            std::uint32_t stack[bvh_type::stackSize];
+            int top = 0;
+            stack[top++] = 0;
+            while (top > 0)
+            {
+                const auto &node = nodes[stack[--top]];
+                if (!packet.intersectBox(node.boxMin, node.boxMax, bestT, tNear)) continue;
+
+                if (node.isLeaf())
+                {
+                    for (auto i = node.index; i < node.index + node.count; ++i)
+                    {
+                        auto mask = packet.intersectTriangle(_triangles[i], bestT);
+                        for (int lane = 0; mask != 0; ++lane, mask >>= 1)
+                            if (mask & 1) hitIDs[lane] = static_cast<int>(_bvh.primitiveOrder()[i]);
+                    }
+                }
+                else
+                {
+                    const auto &c0 = nodes[node.index], &c1 = nodes[node.index + 1];
+                    value_type along = 0;
+                    for (int k = 0; k < 3; ++k)
+                        along += ((c1.boxMin[k] + c1.boxMax[k]) - (c0.boxMin[k] + c0.boxMax[k])) * dir[k];
+                    if (along >= 0) { stack[top++] = node.index + 1; stack[top++] = node.index; }
+                    else            { stack[top++] = node.index; stack[top++] = node.index + 1; }
+                }
+            }
+
+            for (int i = 0; i < N; ++i)
+                if (hitIDs[i] >= 0) rayT[i] = bestT[i];
+        }
+
+        template<int N>
+        void findNearestHitTriangles(const RayPacket3<T, N> &packet, int hitIDs[N], value_type rayT[N]) const
+        { findNearestHitTriangles(packet, std::numeric_limits<value_type>::max(), hitIDs, rayT); }
+
+        // true if any triangle is hit by 'ray' within 'maxDist'; stops at the first hit found
+        bool testAnyHitTriangle(const ray_type &ray,
+                                value_type maxDist = std::numeric_limits<value_type>::max()) const
+        {
+            bool hit = false;
+            auto tMax = maxDist;
+            traverseRay(ray, tMax, [&](std::uint32_t, value_type) { hit = true; return false; });
+            return hit;
+        }
+
+        // index of the triangle closest to 'p' within 'maxDist', -1 if there is none;
+        // 'distSquared' receives the squared distance to it
+        int findNearestTriangle(const vector_type &p, value_type maxDist, value_type &distSquared) const
+        {
+            if (_bvh.empty()) return -1;
+
+            int nearID = -1;
+            auto best = (maxDist < std::sqrt(std::numeric_limits<value_type>::max())) ?
+                maxDist * maxDist : std::numeric_limits<value_type>::max();
+            const auto *nodes = _bvh.nodes();
+
+            std::uint32_t stack[bvh_type::stackSize];
+            int top = 0;
+            stack[top++] = 0;
+            while (top > 0)
+            {
+                const auto &node = nodes[stack[--top]];
+                if (bvh_type::distanceSquared(node, p) > best) continue;
+
+                if (node.isLeaf())
+                {
+                    for (auto i = node.index; i < node.index + node.count; ++i)
+                    {
+                        auto d = _triangles[i].distanceSquared(p);
+                        if (d < best)
+                        {
+                            best = d;
+                            nearID = static_cast<int>(_bvh.primitiveOrder()[i]);
+                        }
+                    }
+                }
+                else
+                {
+                    // visit the closer child first
+                    auto d0 = bvh_type::distanceSquared(nodes[node.index], p);
+                    auto d1 = bvh_type::distanceSquared(nodes[node.index + 1], p);
+                    auto nearChild = (d0 <= d1) ? node.index : node.index + 1;
+                    auto farChild = (d0 <= d1) ? node.index + 1 : node.index;
+                    if (std::max(d0, d1) <= best) stack[top++] = farChild;
+                    if (std::min(d0, d1) <= best) stack[top++] = nearChild;
+                }
+            }
+            if (nearID >= 0) distSquared = best;
+            return nearID;
+        }
+
+        int findNearestTriangle(const vector_type &p,
+                                value_type maxDist = std::numeric_limits<value_type>::max()) const
+        {
+            value_type distSquared;
+            return findNearestTriangle(p, maxDist, distSquared);
+        }
+
+        // appends the indices of all triangles that intersect 'box' to 'triangles'
+        void findOverlappingTriangles(const box_type &box, std::vector<int> &triangles) const
+        {
+            auto bmin = box.minCoordinate(), bmax = box.maxCoordinate();
+            auto center = (bmin + bmax) * value_type(0.5), half = (bmax - bmin) * value_type(0.5);
+            _bvh.traverse(
+                [&](const node_type &node) { return bvh_type::overlaps(node, bmin, bmax); },
+                [&](std::uint32_t begin, std::uint32_t end)
+                {
+                    for (auto i = begin; i < end; ++i)
+                        if (triangleBoxOverlap(_triangles[i], center, half))
+                            triangles.push_back(static_cast<int>(_bvh.primitiveOrder()[i]));
+                    return true;
+                });
+        }
+
+    private:
+        // front-to-back traversal along 'ray' within [0, tMax]; 'hitFunc(i, t)' is called for
+        // every triangle (leaf order index) hit closer than tMax and returns false to stop
+        template<typename HitFunc>
+        void traverseRay(const ray_type &ray, value_type &tMax, HitFunc hitFunc) const
+        {
+            if (_bvh.empty()) return;
+
+            value_type origin[3], invDir[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                origin[k] = ray.origin()[k];
+                invDir[k] = 1 / ray.direction()[k];
+            }
+            const auto *nodes = _bvh.nodes();
+
+            struct Entry { std::uint32_t node; value_type tNear; };
+            Entry stack[bvh_type::stackSize];
+            int top = 0;
+            value_type tNear;
+            if (!bvh_type::intersectRay(nodes[0], origin, invDir, tMax, tNear)) return;
+            stack[top++] = { 0, tNear };
+
+            while (top > 0)
+            {
+                auto entry = stack[--top];
+                if (entry.tNear > tMax) continue;
+                const auto &node = nodes[entry.node];
+
+                if (node.isLeaf())
+                {
+                    for (auto i = node.index; i < node.index + node.count; ++i)
+                    {
+                        value_type t;
+                        if (_triangles[i].intersectRay(ray, t) && t <= tMax)
+                            if (!hitFunc(i, t)) return;
+                    }
+                }
+                else
+                {
+                    value_type t0, t1;
+                    bool hit0 = bvh_type::intersectRay(nodes[node.index], origin, invDir, tMax, t0);
+                    bool hit1 = bvh_type::intersectRay(nodes[node.index + 1], origin, invDir, tMax, t1);
+                    if (hit0 && hit1)
+                    {
+                        // push the farther child first so the nearer one is visited next
+                        if (t0 <= t1) { stack[top++] = { node.index + 1, t1 }; stack[top++] = { node.index, t0 }; }
+                        else          { stack[top++] = { node.index, t0 }; stack[top++] = { node.index + 1, t1 }; }
+                    }
+                    else if (hit0) stack[top++] = { node.index, t0 };
+                    else if (hit1) stack[top++] = { node.index + 1, t1 };
+                }
+            }
+        }
+
+        // separating axis test of a triangle against the box given by center and half extents,
+        // after Akenine-Moller, "Fast 3D Triangle-Box Overlap Testing"
+        static bool triangleBoxOverlap(const triangle_type &tri, const vector_type &center, const vector_type &half)
+        {
+            vector_type v[3] = { tri.v0() - center, tri.v1() - center, tri.v2() - center };
+
+            // box face normals
+            for (int k = 0; k < 3; ++k)
+            {
+                auto pMin = std::min(v[0][k], std::min(v[1][k], v[2][k]));
+                auto pMax = std::max(v[0][k], std::max(v[1][k], v[2][k]));
+                if (pMin > half[k] || pMax < -half[k]) return false;
+            }
+
+            // edge x box axis
+            vector_type e[3] = { v[1] - v[0], v[2] - v[1], v[0] - v[2] };
+            for (int i = 0; i < 3; ++i)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    vector_type unit;
+                    unit[k] = 1;
+                    auto axis = unit.cross(e[i]);
+                    auto p0 = axis.dot(v[0]), p1 = axis.dot(v[1]), p2 = axis.dot(v[2]);
+                    auto r = half.x() * std::abs(axis.x()) + half.y() * std::abs(axis.y()) + half.z() * std::abs(axis.z());
+                    if (std::min(p0, std::min(p1, p2)) > r || std::max(p0, std::max(p1, p2)) < -r) return false;
+                }
+            }
+
+            // triangle normal
+            auto normal = e[0].cross(e[1]);
+            auto r = half.x() * std::abs(normal.x()) + half.y() * std::abs(normal.y()) + half.z() * std::abs(normal.z());
+            return std::abs(normal.dot(v[0])) <= r;
+        }
+
+        bvh_type _bvh;
+        std::vector<triangle_type> _triangles;
+    };
+
+    using TriangleAABBTree3d = TriangleAABBTree3<double>;
+    using TriangleAABBTree3f = TriangleAABBTree3<float>;
+}
+
+#endif